@@ -102,6 +102,8 @@ bool sdl_event_filter(void* userdata, SDL_Event* event) {
         SDL_ControllerDeviceEvent* controller_event = &event->cdevice;
         printf("Controller removed: %d\n", controller_event->which);
         recompinput::remove_controller_state(controller_event->which);
+        // Always queue removals so the UI can stop repeating any keys the controller was holding.
+        recompui::queue_event(*event);
     }
     break;
     case SDL_EventType::SDL_QUIT: {
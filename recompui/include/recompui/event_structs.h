@@ -1,6 +1,9 @@
 #ifndef _RECOMP_UI_EVENT_STRUCTS_H_
 #define _RECOMP_UI_EVENT_STRUCTS_H_
 
+// Every enum value and struct layout that mods pass to or receive from recompui exports is part of the mod API. This
+// includes the values mods pass as plain integers, like style command opcodes, template element kinds and data binding
+// properties. Existing values must never change; new ones are only ever added after the last existing value.
 
 // These three enums must be kept in sync with src/elements/ui_types.h!
 typedef enum {
@@ -25,6 +28,18 @@ typedef enum {
     UI_DRAG_END
 } RecompuiDragPhase;
 
+// Coalescing policies for recompui_register_callback_filtered, which can be combined.
+typedef enum {
+    UI_COALESCE_NONE = 0,
+    // Drag moves that haven't been delivered yet are replaced by the newest position.
+    UI_COALESCE_LATEST_DRAG = 1 << 0,
+    // Hover, focus and enable changes that are undone before they're delivered are dropped in pairs.
+    UI_COALESCE_CANCEL_TOGGLES = 1 << 1
+} RecompuiCoalescePolicy;
+
+// Builds the event mask bit for an event type.
+#define UI_EVENT_MASK(type) (1u << (type))
+
 typedef enum {
     UI_MENU_ACTION_NONE,
     UI_MENU_ACTION_ACCEPT,
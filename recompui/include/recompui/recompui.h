@@ -49,6 +49,29 @@ namespace recompui {
     void queue_event(const SDL_Event& event);
     bool try_deque_event(SDL_Event& out);
 
+    // Counters for the mouse events merged by the UI before they're sent to RmlUi, accumulated since startup.
+    struct InputCoalescingStats {
+        uint64_t motion_events_received = 0;
+        uint64_t motion_events_dispatched = 0;
+        uint64_t wheel_events_received = 0;
+        uint64_t wheel_events_dispatched = 0;
+    };
+    InputCoalescingStats get_input_coalescing_stats();
+
+    // Counters for the element callbacks run in mod code, accumulated since startup.
+    struct UICallbackStats {
+        uint64_t dispatched = 0;
+        // Callbacks skipped because their element or context was destroyed after the event was queued.
+        uint64_t dropped = 0;
+        uint64_t batches = 0;
+        uint64_t context_opens = 0;
+        // Events that were never queued because they weren't in the callback's event mask.
+        uint64_t filtered = 0;
+        // Events that were merged into another queued event or cancelled out by a callback's coalescing policies.
+        uint64_t coalesced = 0;
+    };
+    UICallbackStats get_ui_callback_stats();
+
     std::unique_ptr<UiEventListenerInstancer> make_event_listener_instancer();
     void register_event(UiEventListenerInstancer& listener, const std::string& name, event_handler_t* handler);
 
@@ -65,6 +88,9 @@ namespace recompui {
 
     void init_styling(const std::filesystem::path& rcss_file);
     void init_prompt_context();
+    // Debug overlay listing the UI API profile, which enables profiling while it's shown. Hiding it saves the profile as JSON.
+    void toggle_api_profiler_view();
+    void update_api_profiler_view();
     void open_choice_prompt(
         const std::string& header_text,
         const std::string& content_text,
@@ -114,6 +140,14 @@ namespace recompui {
 
     void queue_image_from_bytes_rgba32(const std::string &src, const std::vector<char> &bytes, uint32_t width, uint32_t height);
     void queue_image_from_bytes_file(const std::string &src, const std::vector<char> &bytes);
+    // Dynamic images are RGBA32 images that can be updated in place after they're created. Updates are copied immediately
+    // and uploaded by the renderer over the following frames. Returns false if the image doesn't exist or the region is out of bounds.
+    // They're identified by a mod texture handle and loaded through that texture's source.
+    void create_dynamic_image(uint32_t texture, uint32_t width, uint32_t height);
+    bool update_dynamic_image(uint32_t texture, const char *bytes, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+    // Gets the size of a dynamic image without touching its pixels. Returns false if the image doesn't exist.
+    bool get_dynamic_image_size(uint32_t texture, uint32_t &width, uint32_t &height);
+    void release_dynamic_image(uint32_t texture);
     void release_image(const std::string &src);
 
     void drop_files(const std::list<std::filesystem::path> &file_list);
@@ -2,6 +2,11 @@
 
 #include "ui_helpers.h"
 #include "ui_api_images.h"
+#include "ui_api_profiler.h"
+#include "ui_api_style.h"
+#include "ui_api_strings.h"
+#include "ui_api_templates.h"
+#include "ui_api_bindings.h"
 
 #include "core/ui_context.h"
 #include "core/ui_resource.h"
@@ -84,6 +89,7 @@ void recompui_set_context_captures_mouse(uint8_t* rdram, recomp_context* ctx) {
 // Resources
 void recompui_create_style(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
 
     Style* ret = ui_context.create_style();
     return_resource(ctx, ret->get_resource_id());
@@ -91,12 +97,40 @@ void recompui_create_style(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_element(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
 
     Element* ret = ui_context.create_element<Element>(parent);
     return_resource(ctx, ret->get_resource_id());
 }
 
+void recompui_create_detached_element(uint8_t* rdram, recomp_context* ctx) {
+    ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
+
+    Element* ret = ui_context.create_detached_element<Element>();
+    return_resource(ctx, ret->get_resource_id());
+}
+
+void recompui_attach_element(uint8_t* rdram, recomp_context* ctx) {
+    ContextId ui_context = get_context(rdram, ctx);
+    Element* parent = arg_element<1>(rdram, ctx, ui_context);
+    Element* element = arg_element<2>(rdram, ctx, ui_context);
+
+    ui_context.attach_element(element, parent);
+}
+
+void recompui_destroy_detached_element(uint8_t* rdram, recomp_context* ctx) {
+    ContextId ui_context = get_context(rdram, ctx);
+    Element* element = arg_element<1>(rdram, ctx, ui_context);
+
+    if (!ui_context.destroy_detached_element(element)) {
+        recompui::message_box("Fatal error in mod - attempted to destroy an element that isn't detached");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+}
+
 void recompui_destroy_element(uint8_t* rdram, recomp_context* ctx) {
     Style* parent_resource = arg_style<0>(rdram, ctx);
 
@@ -118,8 +152,9 @@ void recompui_destroy_element(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_button(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
-    std::string text = _arg_string<2>(rdram, ctx);
+    std::string text = arg_text<2>(rdram, ctx);
     uint32_t style = _arg<3, uint32_t>(rdram, ctx);
 
     Button* ret = ui_context.create_element<Button>(parent, text, static_cast<ButtonStyle>(style));
@@ -128,8 +163,9 @@ void recompui_create_button(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_label(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
-    std::string text = _arg_string<2>(rdram, ctx);
+    std::string text = arg_text<2>(rdram, ctx);
     uint32_t style = _arg<3, uint32_t>(rdram, ctx);
 
     Element* ret = ui_context.create_element<Label>(parent, text, static_cast<LabelStyle>(style));
@@ -138,8 +174,9 @@ void recompui_create_label(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_span(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
-    std::string text = _arg_string<2>(rdram, ctx);
+    std::string text = arg_text<2>(rdram, ctx);
 
     Element* ret = ui_context.create_element<Span>(parent, text);
     return_resource(ctx, ret->get_resource_id());
@@ -147,6 +184,7 @@ void recompui_create_span(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_textinput(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
 
     Element* ret = ui_context.create_element<TextInput>(parent);
@@ -155,6 +193,7 @@ void recompui_create_textinput(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_passwordinput(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
 
     Element* ret = ui_context.create_element<TextInput>(parent, false);
@@ -163,6 +202,7 @@ void recompui_create_passwordinput(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_labelradio(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
     PTR(PTR(char)) options = _arg<2, PTR(PTR(char))>(rdram, ctx);
     uint32_t num_options = _arg<3, uint32_t>(rdram, ctx);
@@ -170,7 +210,7 @@ void recompui_create_labelradio(uint8_t* rdram, recomp_context* ctx) {
     Radio* ret = ui_context.create_element<Radio>(parent);
 
     for (size_t i = 0; i < num_options; i++) {
-        ret->add_option(decode_string(rdram, MEM_W(sizeof(uint32_t) * i, options)));
+        ret->add_option(decode_text(rdram, MEM_W(sizeof(uint32_t) * i, options)));
     }
 
     return_resource(ctx, ret->get_resource_id());
@@ -178,6 +218,7 @@ void recompui_create_labelradio(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_slider(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
     uint32_t type = _arg<2, uint32_t>(rdram, ctx);
     float min_value = arg_float3(rdram, ctx);
@@ -650,7 +691,18 @@ void recompui_set_text(uint8_t* rdram, recomp_context* ctx) {
     }
 
     Element* element = static_cast<Element*>(resource);
-    element->set_text(_arg_string<1>(rdram, ctx));
+    PTR(char) text = _arg<1, PTR(char)>(rdram, ctx);
+
+    // Text set from an interned string is only decoded and applied when the handle changes.
+    if (is_interned_string_handle(text)) {
+        uint32_t handle = static_cast<uint32_t>(text);
+        if (!element->has_interned_text(handle)) {
+            element->set_interned_text(handle, get_interned_string(handle));
+        }
+    }
+    else {
+        element->set_text(decode_string(rdram, text));
+    }
 }
 
 void recompui_set_font_size(uint8_t* rdram, recomp_context* ctx) {
@@ -818,7 +870,7 @@ void recompui_set_input_text(uint8_t* rdram, recomp_context* ctx) {
     }
 
     Element* element = static_cast<Element*>(resource);
-    element->set_input_text(_arg_string<1>(rdram, ctx));
+    element->set_input_text(arg_text<1>(rdram, ctx));
 }
 
 // Callbacks
@@ -846,6 +898,32 @@ void recompui_register_callback(uint8_t* rdram, recomp_context* ctx) {
     element->register_callback(ui_context, callback, userdata);
 }
 
+void recompui_register_callback_filtered(uint8_t* rdram, recomp_context* ctx) {
+    ContextId ui_context = recompui::get_current_context();
+
+    if (ui_context == ContextId::null()) {
+        recompui::message_box("Fatal error in mod - attempted to register callback with no active context");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    Style* resource = arg_style<0>(rdram, ctx);
+
+    if (resource == nullptr || !resource->is_element()) {
+        recompui::message_box("Fatal error in mod - attempted to register callback on non-element or element not found in context");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    Element* element = static_cast<Element*>(resource);
+    PTR(void) callback = _arg<1, PTR(void)>(rdram, ctx);
+    PTR(void) userdata = _arg<2, PTR(void)>(rdram, ctx);
+    uint32_t event_mask = _arg<3, uint32_t>(rdram, ctx);
+    uint32_t coalesce_policies = MEM_W(0x10, ctx->r29);
+
+    element->register_callback(ui_context, callback, userdata, event_mask, coalesce_policies);
+}
+
 // Navigation
 void recompui_set_nav_auto(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = recompui::get_current_context();
@@ -925,7 +1003,7 @@ void recompui_set_nav(uint8_t* rdram, recomp_context* ctx) {
     element->set_nav(static_cast<recompui::NavDirection>(nav_dir), target_element);
 }
 
-#define REGISTER_FUNC(name) recomp::overlays::register_base_export(#name, name)
+#define REGISTER_FUNC(name) recompui::register_ui_export<name>(#name)
 
 void recompui::register_ui_exports() {
     REGISTER_FUNC(recompui_create_context);
@@ -938,6 +1016,9 @@ void recompui::register_ui_exports() {
     REGISTER_FUNC(recompui_set_context_captures_mouse);
     REGISTER_FUNC(recompui_create_style);
     REGISTER_FUNC(recompui_create_element);
+    REGISTER_FUNC(recompui_create_detached_element);
+    REGISTER_FUNC(recompui_attach_element);
+    REGISTER_FUNC(recompui_destroy_detached_element);
     REGISTER_FUNC(recompui_destroy_element);
     REGISTER_FUNC(recompui_create_button);
     REGISTER_FUNC(recompui_create_label);
@@ -1027,5 +1108,10 @@ void recompui::register_ui_exports() {
     REGISTER_FUNC(recompui_set_nav_none);
     REGISTER_FUNC(recompui_set_nav);
     REGISTER_FUNC(recompui_register_callback);
+    REGISTER_FUNC(recompui_register_callback_filtered);
     register_ui_image_exports();
+    register_ui_style_exports();
+    register_ui_string_exports();
+    register_ui_template_exports();
+    register_ui_binding_exports();
 }
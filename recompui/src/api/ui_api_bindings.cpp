@@ -0,0 +1,114 @@
+#include "recompui.h"
+#include "librecomp/overlays.hpp"
+#include "librecomp/helpers.hpp"
+#include "librecomp/addresses.hpp"
+#include "ultramodern/error_handling.hpp"
+
+#include "ui_helpers.h"
+#include "ui_api_bindings.h"
+#include "ui_api_profiler.h"
+#include "elements/ui_data_binding.h"
+
+using namespace recompui;
+
+static Element* arg_bound_element(uint8_t* rdram, recomp_context* ctx, ContextId ui_context) {
+    if (ui_context == ContextId::null()) {
+        recompui::message_box("Fatal error in mod - attempted to change a data binding with no active context");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    Style* resource = arg_style<0>(rdram, ctx);
+
+    if (resource == nullptr || !resource->is_element()) {
+        recompui::message_box("Fatal error in mod - attempted to change a data binding of non-element or element not found in context");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    return static_cast<Element*>(resource);
+}
+
+static DataBindingProperty arg_binding_property(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t property = _arg<1, uint32_t>(rdram, ctx);
+
+    if (property > static_cast<uint32_t>(DataBindingProperty::Visibility)) {
+        recompui::message_box("Fatal error in mod - invalid data binding property");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    return static_cast<DataBindingProperty>(property);
+}
+
+// Bindings are sampled every frame, so the whole value has to lie within the KSEG0 view of rdram.
+static bool is_valid_binding_address(PTR(void) address, DataBindingType type) {
+    uint32_t address_u32 = static_cast<uint32_t>(address);
+    uint32_t type_size = DataBinding::get_type_size(type);
+    return address_u32 >= 0x80000000U && address_u32 - 0x80000000U <= recomp::mem_size - type_size;
+}
+
+static std::string get_default_format(DataBindingType type) {
+    switch (type) {
+    case DataBindingType::S8:
+    case DataBindingType::S16:
+    case DataBindingType::S32:
+        return "%d";
+    case DataBindingType::F32:
+        return "%g";
+    default:
+        return "%u";
+    }
+}
+
+void recompui_bind_data(uint8_t* rdram, recomp_context* ctx) {
+    ContextId ui_context = recompui::get_current_context();
+    Element* element = arg_bound_element(rdram, ctx, ui_context);
+    DataBindingProperty binding_property = arg_binding_property(rdram, ctx);
+    uint32_t type = _arg<2, uint32_t>(rdram, ctx);
+    PTR(void) address = _arg<3, PTR(void)>(rdram, ctx);
+    PTR(char) format_ptr = MEM_W(0x10, ctx->r29);
+
+    if (type > static_cast<uint32_t>(DataBindingType::F32)) {
+        recompui::message_box("Fatal error in mod - invalid data binding type");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    DataBindingType binding_type = static_cast<DataBindingType>(type);
+    if (!is_valid_binding_address(address, binding_type)) {
+        recompui::message_box("Fatal error in mod - data binding address is null or outside of rdram");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    if ((address & (DataBinding::get_type_size(binding_type) - 1)) != 0) {
+        recompui::message_box("Fatal error in mod - data binding address is not aligned to its type");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    std::string format = format_ptr != 0 ? decode_text(rdram, format_ptr) : get_default_format(binding_type);
+    if (binding_property == DataBindingProperty::Text && !DataBinding::is_valid_format(format, binding_type)) {
+        recompui::message_box("Fatal error in mod - data binding format must have exactly one conversion that matches its type");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    ui_context.add_data_binding(element, DataBinding{ binding_property, binding_type, rdram, address, format });
+}
+
+void recompui_unbind_data(uint8_t* rdram, recomp_context* ctx) {
+    ContextId ui_context = recompui::get_current_context();
+    Element* element = arg_bound_element(rdram, ctx, ui_context);
+    DataBindingProperty binding_property = arg_binding_property(rdram, ctx);
+
+    ui_context.remove_data_binding(element, binding_property);
+}
+
+#define REGISTER_FUNC(name) recompui::register_ui_export<name>(#name)
+
+void recompui::register_ui_binding_exports() {
+    REGISTER_FUNC(recompui_bind_data);
+    REGISTER_FUNC(recompui_unbind_data);
+}
@@ -1,3 +1,6 @@
+#include <atomic>
+#include <vector>
+
 #include "concurrentqueue.h"
 
 #include "overloaded.h"
@@ -30,12 +33,156 @@ struct QueuedCallback {
     recompui::ResourceId resource;
     recompui::Event event;
     recompui::UICallback callback;
+    // Identifies the event to the callback's coalescer, if it has one.
+    uint32_t coalesce_serial;
 };
 
 moodycamel::ConcurrentQueue<QueuedCallback> queued_callbacks{};
 
+// Maximum number of callbacks dequeued at once.
+constexpr size_t callback_batch_size = 64;
+
+static struct {
+    std::atomic<uint64_t> dispatched = 0;
+    std::atomic<uint64_t> dropped = 0;
+    std::atomic<uint64_t> batches = 0;
+    std::atomic<uint64_t> context_opens = 0;
+    std::atomic<uint64_t> filtered = 0;
+    std::atomic<uint64_t> coalesced = 0;
+} ui_callback_stats;
+
+recompui::UICallbackStats recompui::get_ui_callback_stats() {
+    recompui::UICallbackStats ret{};
+    ret.dispatched = ui_callback_stats.dispatched.load();
+    ret.dropped = ui_callback_stats.dropped.load();
+    ret.batches = ui_callback_stats.batches.load();
+    ret.context_opens = ui_callback_stats.context_opens.load();
+    ret.filtered = ui_callback_stats.filtered.load();
+    ret.coalesced = ui_callback_stats.coalesced.load();
+    return ret;
+}
+
+recompui::UICallbackCoalescer::QueuedToggle* recompui::UICallbackCoalescer::get_toggle(EventType type) {
+    switch (type) {
+        case EventType::Hover:
+            return &hover;
+        case EventType::Focus:
+            return &focus;
+        case EventType::Enable:
+            return &enable;
+        default:
+            return nullptr;
+    }
+}
+
+static bool get_toggle_active(const recompui::Event& e) {
+    switch (e.type) {
+        case recompui::EventType::Hover:
+            return std::get<recompui::EventHover>(e.variant).active;
+        case recompui::EventType::Focus:
+            return std::get<recompui::EventFocus>(e.variant).active;
+        case recompui::EventType::Enable:
+            return std::get<recompui::EventEnable>(e.variant).active;
+        default:
+            assert(false && "Not a toggle event.");
+            return false;
+    }
+}
+
+bool recompui::UICallbackCoalescer::on_queue(const Event& e, uint32_t& serial) {
+    std::lock_guard lock{ mutex };
+    serial = 0;
+
+    if (e.type == EventType::Drag && (policies & static_cast<uint32_t>(CallbackCoalescePolicy::LatestDrag))) {
+        const EventDrag& drag = std::get<EventDrag>(e.variant);
+        if (drag.phase != DragPhase::Move) {
+            drag_queued = false;
+            return true;
+        }
+
+        latest_drag = drag;
+        if (drag_queued) {
+            return false;
+        }
+
+        drag_queued = true;
+        serial = ++drag_serial;
+        return true;
+    }
+
+    QueuedToggle* toggle = get_toggle(e.type);
+    if (toggle != nullptr && (policies & static_cast<uint32_t>(CallbackCoalescePolicy::CancelToggles))) {
+        bool active = get_toggle_active(e);
+        if (!toggle->queued) {
+            toggle->queued = true;
+            toggle->cancelled = false;
+            toggle->active = active;
+            return true;
+        }
+
+        // An opposite change cancels out the queued one, and a change after that revives it with the new state.
+        if (toggle->cancelled) {
+            toggle->cancelled = false;
+            toggle->active = active;
+        }
+        else if (toggle->active != active) {
+            toggle->cancelled = true;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool recompui::UICallbackCoalescer::on_dispatch(Event& e, uint32_t serial) {
+    std::lock_guard lock{ mutex };
+
+    if (e.type == EventType::Drag && (policies & static_cast<uint32_t>(CallbackCoalescePolicy::LatestDrag))) {
+        // A move that was followed by the end of its drag keeps its own position, as the end event carries the final one.
+        if (drag_queued && serial == drag_serial) {
+            e.variant = latest_drag;
+            drag_queued = false;
+        }
+        return true;
+    }
+
+    QueuedToggle* toggle = get_toggle(e.type);
+    if (toggle != nullptr && (policies & static_cast<uint32_t>(CallbackCoalescePolicy::CancelToggles))) {
+        toggle->queued = false;
+        if (toggle->cancelled) {
+            return false;
+        }
+
+        switch (e.type) {
+            case EventType::Hover:
+                e.variant = EventHover{ toggle->active };
+                break;
+            case EventType::Focus:
+                e.variant = EventFocus{ toggle->active };
+                break;
+            default:
+                e.variant = EventEnable{ toggle->active };
+                break;
+        }
+    }
+
+    return true;
+}
+
 void recompui::queue_ui_callback(recompui::ResourceId resource, const Event& e, const UICallback& callback) {
-    queued_callbacks.enqueue(QueuedCallback{ .resource = resource, .event = e, .callback = callback });
+    // Filter events before they're queued so that events the callback doesn't want never reach mod code.
+    if ((callback.event_mask & Events(e.type)) == 0) {
+        ui_callback_stats.filtered++;
+        return;
+    }
+
+    uint32_t coalesce_serial = 0;
+    if (callback.coalescer && !callback.coalescer->on_queue(e, coalesce_serial)) {
+        ui_callback_stats.coalesced++;
+        return;
+    }
+
+    queued_callbacks.enqueue(QueuedCallback{ .resource = resource, .event = e, .callback = callback, .coalesce_serial = coalesce_serial });
 }
 
 bool convert_event(const recompui::Event& in, RecompuiEventData& out) {
@@ -105,19 +252,58 @@ extern "C" void recomp_run_ui_callbacks(uint8_t* rdram, recomp_context* ctx) {
     ctx->r29 -= sizeof(RecompuiEventData);
     RecompuiEventData* event_data = TO_PTR(RecompuiEventData, stack_frame);
 
-    QueuedCallback cur_callback;
+    thread_local std::vector<QueuedCallback> batch(callback_batch_size);
+
+    // Keep dequeuing until the queue is empty, as callbacks can cause more events to be queued.
+    size_t batch_count;
+    while ((batch_count = queued_callbacks.try_dequeue_bulk(batch.begin(), batch.size())) != 0) {
+        ui_callback_stats.batches++;
+
+        // Run each run of callbacks for the same context with the context opened once.
+        size_t group_start = 0;
+        while (group_start < batch_count) {
+            recompui::ContextId cur_context = batch[group_start].callback.context;
+            size_t group_end = group_start + 1;
+            while (group_end < batch_count && batch[group_end].callback.context == cur_context) {
+                group_end++;
+            }
+
+            if (!cur_context.exists()) {
+                ui_callback_stats.dropped += group_end - group_start;
+                group_start = group_end;
+                continue;
+            }
 
-    while (queued_callbacks.try_dequeue(cur_callback)) {
-        if (convert_event(cur_callback.event, *event_data)) {
-            recompui::ContextId cur_context = cur_callback.callback.context;
             cur_context.open();
+            ui_callback_stats.context_opens++;
+
+            for (size_t i = group_start; i < group_end; i++) {
+                QueuedCallback& cur_callback = batch[i];
+
+                // Skip callbacks for elements that were destroyed after the event was queued, including by earlier callbacks.
+                if (!cur_context.has_resource(cur_callback.resource)) {
+                    ui_callback_stats.dropped++;
+                    continue;
+                }
 
-            ctx->r4 = static_cast<int32_t>(cur_callback.resource.slot_id);
-            ctx->r5 = stack_frame;
-            ctx->r6 = cur_callback.callback.userdata;
+                // Pick up whatever was merged into the event while it was queued.
+                if (cur_callback.callback.coalescer && !cur_callback.callback.coalescer->on_dispatch(cur_callback.event, cur_callback.coalesce_serial)) {
+                    ui_callback_stats.coalesced++;
+                    continue;
+                }
+
+                if (convert_event(cur_callback.event, *event_data)) {
+                    ctx->r4 = static_cast<int32_t>(cur_callback.resource.slot_id);
+                    ctx->r5 = stack_frame;
+                    ctx->r6 = cur_callback.callback.userdata;
+
+                    LOOKUP_FUNC(cur_callback.callback.callback)(rdram, ctx);
+                    ui_callback_stats.dispatched++;
+                }
+            }
 
-            LOOKUP_FUNC(cur_callback.callback.callback)(rdram, ctx);
             cur_context.close();
+            group_start = group_end;
         }
     }
 
@@ -1,6 +1,3 @@
-#include <mutex>
-#include <unordered_set>
-
 #include "recompui.h"
 #include "librecomp/overlays.hpp"
 #include "librecomp/helpers.hpp"
@@ -8,41 +5,47 @@
 
 #include "ui_helpers.h"
 #include "ui_api_images.h"
+#include "ui_api_profiler.h"
+#include "core/ui_texture_registry.h"
 #include "elements/ui_image.h"
 
 using namespace recompui;
 
-struct {
-    std::mutex mutex;
-    std::unordered_set<uint32_t> textures{};
-    uint32_t textures_created = 0;
-} TextureState;
+static uint32_t create_texture() {
+    uint32_t texture_id = create_texture_handle();
 
-const std::string mod_texture_prefix = "?/mod_api/";
+    if (texture_id == 0) {
+        recompui::message_box("Fatal error in mod - too many textures");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
 
-static std::string get_texture_name(uint32_t texture_id) {
-    return mod_texture_prefix + std::to_string(texture_id);
+    return texture_id;
 }
 
-static uint32_t get_new_texture_id() {
-    std::lock_guard lock{TextureState.mutex};
-    uint32_t cur_id = TextureState.textures_created++;
-    TextureState.textures.emplace(cur_id);
+static std::string get_texture_source_checked(uint32_t texture_id) {
+    std::string texture_source;
 
-    return cur_id;
+    if (!get_texture_source(texture_id, texture_source)) {
+        recompui::message_box("Fatal error in mod - attempted to use a texture that doesn't exist");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    return texture_source;
 }
 
 static void release_texture(uint32_t texture_id) {
-    std::string texture_name = get_texture_name(texture_id);
-    std::lock_guard lock{TextureState.mutex};
+    std::string texture_source;
 
-    if (TextureState.textures.erase(texture_id) == 0) {
+    if (!get_texture_source(texture_id, texture_source) || !release_texture_handle(texture_id)) {
         recompui::message_box("Fatal error in mod - attempted to destroy texture that doesn't exist!");
         assert(false);
         ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
     }
 
-    recompui::release_image(texture_name);
+    recompui::release_image(texture_source);
+    recompui::release_dynamic_image(texture_id);
 }
 
 thread_local std::vector<char> swapped_image_bytes;
@@ -51,20 +54,17 @@ void recompui_create_texture_rgba32(uint8_t* rdram, recomp_context* ctx) {
     PTR(void) data_in = _arg<0, PTR(void)>(rdram, ctx);
     uint32_t width = _arg<1, uint32_t>(rdram, ctx);
     uint32_t height = _arg<2, uint32_t>(rdram, ctx);
-    uint32_t cur_id = get_new_texture_id();
+    uint32_t cur_id = create_texture();
 
     // The size in bytes of the image's pixel data.
     size_t size_bytes = width * height * 4 * sizeof(uint8_t);
     swapped_image_bytes.resize(size_bytes);
 
     // Byteswap copy the pixel data.
-    for (size_t i = 0; i < size_bytes; i++) {
-        swapped_image_bytes[i] = MEM_B(i, data_in);
-    }
+    recompui::copy_from_rdram(rdram, swapped_image_bytes.data(), data_in, size_bytes);
 
-    // Create a texture name from the ID and queue its bytes.
-    std::string texture_name = get_texture_name(cur_id);
-    recompui::queue_image_from_bytes_rgba32(texture_name, swapped_image_bytes, width, height);
+    // Queue the bytes under the texture's source.
+    recompui::queue_image_from_bytes_rgba32(get_texture_source_checked(cur_id), swapped_image_bytes, width, height);
 
     // Return the new texture ID.
     _return(ctx, cur_id);
@@ -73,24 +73,70 @@ void recompui_create_texture_rgba32(uint8_t* rdram, recomp_context* ctx) {
 void recompui_create_texture_image_bytes(uint8_t* rdram, recomp_context* ctx) {
     PTR(void) data_in = _arg<0, PTR(void)>(rdram, ctx);
     uint32_t size_bytes = _arg<1, u32>(rdram, ctx);
-    uint32_t cur_id = get_new_texture_id();
+    uint32_t cur_id = create_texture();
 
     // The size in bytes of the image's data.
     swapped_image_bytes.resize(size_bytes);
 
     // Byteswap copy the image's data.
-    for (size_t i = 0; i < size_bytes; i++) {
-        swapped_image_bytes[i] = MEM_B(i, data_in);
-    }
+    recompui::copy_from_rdram(rdram, swapped_image_bytes.data(), data_in, size_bytes);
 
-    // Create a texture name from the ID and queue its bytes.
-    std::string texture_name = get_texture_name(cur_id);
-    recompui::queue_image_from_bytes_file(texture_name, swapped_image_bytes);
+    // Queue the bytes under the texture's source.
+    recompui::queue_image_from_bytes_file(get_texture_source_checked(cur_id), swapped_image_bytes);
 
     // Return the new texture ID.
     _return(ctx, cur_id);
 }
 
+void recompui_create_dynamic_texture(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t width = _arg<0, uint32_t>(rdram, ctx);
+    uint32_t height = _arg<1, uint32_t>(rdram, ctx);
+
+    if (width == 0 || height == 0) {
+        recompui::message_box("Fatal error in mod - attempted to create a dynamic texture with no pixels");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    uint32_t cur_id = create_texture();
+
+    // The texture starts out fully transparent and stays allocated until it's destroyed, so it can be updated every frame.
+    recompui::create_dynamic_image(cur_id, width, height);
+
+    _return(ctx, cur_id);
+}
+
+void recompui_update_dynamic_texture(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t texture_id = _arg<0, uint32_t>(rdram, ctx);
+    PTR(void) data_in = _arg<1, PTR(void)>(rdram, ctx);
+    uint32_t x = _arg<2, uint32_t>(rdram, ctx);
+    uint32_t y = _arg<3, uint32_t>(rdram, ctx);
+    uint32_t width = MEM_W(0x10, ctx->r29);
+    uint32_t height = MEM_W(0x14, ctx->r29);
+
+    // Validate the region before copying anything, as the size of the copy comes from the mod.
+    uint32_t image_width;
+    uint32_t image_height;
+    if (!recompui::get_dynamic_image_size(texture_id, image_width, image_height) ||
+        x > image_width || y > image_height || width > image_width - x || height > image_height - y)
+    {
+        recompui::message_box("Fatal error in mod - attempted to update a texture that isn't dynamic or outside of its bounds");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    // The pixel data only covers the updated region, with no padding between rows.
+    size_t size_bytes = size_t(width) * height * 4 * sizeof(uint8_t);
+    swapped_image_bytes.resize(size_bytes);
+    recompui::copy_from_rdram(rdram, swapped_image_bytes.data(), data_in, size_bytes);
+
+    if (!recompui::update_dynamic_image(texture_id, swapped_image_bytes.data(), x, y, width, height)) {
+        recompui::message_box("Fatal error in mod - attempted to update a texture that isn't dynamic or outside of its bounds");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+}
+
 void recompui_destroy_texture(uint8_t* rdram, recomp_context* ctx) {
     uint32_t texture_id = _arg<0, uint32_t>(rdram, ctx);
 
@@ -99,10 +145,11 @@ void recompui_destroy_texture(uint8_t* rdram, recomp_context* ctx) {
 
 void recompui_create_imageview(uint8_t* rdram, recomp_context* ctx) {
     ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
     Element* parent = arg_element<1>(rdram, ctx, ui_context);
     uint32_t texture_id = _arg<2, uint32_t>(rdram, ctx);
 
-    Element* ret = ui_context.create_element<Image>(parent, get_texture_name(texture_id));
+    Element* ret = ui_context.create_element<Image>(parent, texture_id, get_texture_source_checked(texture_id));
     return_resource(ctx, ret->get_resource_id());
 }
 
@@ -116,15 +163,26 @@ void recompui_set_imageview_texture(uint8_t* rdram, recomp_context* ctx) {
         ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
     }
 
+    // Swapping back and forth between textures only looks up the texture's source when it changes, but the texture
+    // still has to be alive even if it's the one the element already shows.
     Element* element = static_cast<Element*>(resource);
-    element->set_src(get_texture_name(texture_id));
+    if (!element->has_texture_src(texture_id)) {
+        element->set_texture_src(texture_id, get_texture_source_checked(texture_id));
+    }
+    else if (!is_texture_handle_alive(texture_id)) {
+        recompui::message_box("Fatal error in mod - attempted to use a texture that doesn't exist");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
 }
 
-#define REGISTER_FUNC(name) recomp::overlays::register_base_export(#name, name)
+#define REGISTER_FUNC(name) recompui::register_ui_export<name>(#name)
 
 void recompui::register_ui_image_exports() {
     REGISTER_FUNC(recompui_create_texture_rgba32);
     REGISTER_FUNC(recompui_create_texture_image_bytes);
+    REGISTER_FUNC(recompui_create_dynamic_texture);
+    REGISTER_FUNC(recompui_update_dynamic_texture);
     REGISTER_FUNC(recompui_destroy_texture);
     REGISTER_FUNC(recompui_create_imageview);
     REGISTER_FUNC(recompui_set_imageview_texture);
@@ -0,0 +1,195 @@
+#include "ui_api_profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace recompui {
+    namespace api_profiler {
+        std::atomic<bool> enabled = false;
+    }
+
+    // Number of distinct export and context pairs each thread can record. Calls that don't fit are only counted as dropped.
+    constexpr size_t profile_table_capacity = 1024;
+    constexpr uint64_t empty_profile_key = UINT64_MAX;
+
+    struct ProfileSlot {
+        std::atomic<uint64_t> key = empty_profile_key;
+        std::atomic<uint64_t> calls = 0;
+        std::atomic<uint64_t> host_time_ns = 0;
+        std::atomic<uint64_t> rdram_bytes = 0;
+    };
+
+    // Only the owning thread writes to a table, so recording a call never takes a lock. Other threads only read the
+    // counters, which are atomics so that the reads are well defined.
+    struct ThreadProfileTable {
+        std::array<ProfileSlot, profile_table_capacity> slots;
+        std::atomic<uint64_t> dropped_calls = 0;
+        // The reset generation that this table's contents belong to.
+        std::atomic<uint32_t> generation = 0;
+    };
+
+    static struct {
+        std::mutex mutex;
+        // Tables are kept until shutdown so a table can still be read after its thread exits.
+        std::vector<std::unique_ptr<ThreadProfileTable>> tables;
+        std::vector<std::string> export_names;
+        std::atomic<uint32_t> generation = 0;
+    } profiler_state;
+
+    thread_local ThreadProfileTable* thread_profile_table = nullptr;
+
+    static uint64_t make_profile_key(uint32_t export_index, ContextId context) {
+        return (uint64_t(export_index) << 32) | context.slot_id;
+    }
+
+    // Adds to an atomic that only the current thread writes to, which doesn't need a read-modify-write.
+    static void add_owned(std::atomic<uint64_t>& value, uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static ThreadProfileTable* get_thread_profile_table() {
+        if (thread_profile_table == nullptr) {
+            auto table = std::make_unique<ThreadProfileTable>();
+            table->generation.store(profiler_state.generation.load());
+            thread_profile_table = table.get();
+
+            std::lock_guard lock{ profiler_state.mutex };
+            profiler_state.tables.emplace_back(std::move(table));
+        }
+
+        ThreadProfileTable* table = thread_profile_table;
+
+        // Clear the table if the profile was reset since it was last written to.
+        uint32_t cur_generation = profiler_state.generation.load(std::memory_order_acquire);
+        if (table->generation.load(std::memory_order_relaxed) != cur_generation) {
+            for (ProfileSlot& slot : table->slots) {
+                slot.key.store(empty_profile_key, std::memory_order_relaxed);
+                slot.calls.store(0, std::memory_order_relaxed);
+                slot.host_time_ns.store(0, std::memory_order_relaxed);
+                slot.rdram_bytes.store(0, std::memory_order_relaxed);
+            }
+            table->dropped_calls.store(0, std::memory_order_relaxed);
+            table->generation.store(cur_generation, std::memory_order_release);
+        }
+
+        return table;
+    }
+
+    uint32_t api_profiler::add_export(const char* name) {
+        std::lock_guard lock{ profiler_state.mutex };
+        profiler_state.export_names.emplace_back(name);
+        return uint32_t(profiler_state.export_names.size() - 1);
+    }
+
+    void api_profiler::record_call(uint32_t export_index, ContextId context, std::chrono::steady_clock::duration host_time, uint64_t rdram_bytes) {
+        ThreadProfileTable* table = get_thread_profile_table();
+        uint64_t key = make_profile_key(export_index, context);
+
+        // Find the slot for this key with linear probing, claiming an empty one if the key hasn't been seen yet.
+        size_t start_index = std::hash<uint64_t>{}(key) % profile_table_capacity;
+        for (size_t i = 0; i < profile_table_capacity; i++) {
+            ProfileSlot& slot = table->slots[(start_index + i) % profile_table_capacity];
+            uint64_t slot_key = slot.key.load(std::memory_order_relaxed);
+            if (slot_key == empty_profile_key) {
+                // The counters are already zero, so publishing the key is enough to claim the slot.
+                slot.key.store(key, std::memory_order_release);
+                slot_key = key;
+            }
+
+            if (slot_key == key) {
+                add_owned(slot.calls, 1);
+                add_owned(slot.host_time_ns, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(host_time).count()));
+                add_owned(slot.rdram_bytes, rdram_bytes);
+                return;
+            }
+        }
+
+        add_owned(table->dropped_calls, 1);
+    }
+
+    void set_api_profiling_enabled(bool enabled) {
+        api_profiler::enabled.store(enabled);
+    }
+
+    bool is_api_profiling_enabled() {
+        return api_profiler::enabled.load();
+    }
+
+    void reset_api_profile() {
+        profiler_state.generation.fetch_add(1, std::memory_order_release);
+    }
+
+    static std::vector<ApiProfileEntry> collect_api_profile(uint64_t& dropped_calls) {
+        std::lock_guard lock{ profiler_state.mutex };
+        uint32_t cur_generation = profiler_state.generation.load(std::memory_order_acquire);
+        std::unordered_map<uint64_t, ApiProfileEntry> totals;
+        dropped_calls = 0;
+
+        for (const auto& table : profiler_state.tables) {
+            // Skip tables that haven't been cleared since the last reset.
+            if (table->generation.load(std::memory_order_acquire) != cur_generation) {
+                continue;
+            }
+
+            dropped_calls += table->dropped_calls.load(std::memory_order_relaxed);
+            for (const ProfileSlot& slot : table->slots) {
+                uint64_t key = slot.key.load(std::memory_order_acquire);
+                if (key == empty_profile_key) {
+                    continue;
+                }
+
+                ApiProfileEntry& entry = totals[key];
+                entry.calls += slot.calls.load(std::memory_order_relaxed);
+                entry.host_time_ns += slot.host_time_ns.load(std::memory_order_relaxed);
+                entry.rdram_bytes += slot.rdram_bytes.load(std::memory_order_relaxed);
+            }
+        }
+
+        std::vector<ApiProfileEntry> ret;
+        ret.reserve(totals.size());
+        for (auto& [key, entry] : totals) {
+            uint32_t export_index = uint32_t(key >> 32);
+            entry.export_name = export_index < profiler_state.export_names.size() ? profiler_state.export_names[export_index] : "unknown";
+            entry.context = ContextId{ .slot_id = uint32_t(key) };
+            ret.emplace_back(std::move(entry));
+        }
+
+        std::sort(ret.begin(), ret.end(), [](const ApiProfileEntry& lhs, const ApiProfileEntry& rhs) {
+            return lhs.host_time_ns > rhs.host_time_ns;
+        });
+
+        return ret;
+    }
+
+    std::vector<ApiProfileEntry> get_api_profile() {
+        uint64_t dropped_calls;
+        return collect_api_profile(dropped_calls);
+    }
+
+    std::string get_api_profile_json() {
+        uint64_t dropped_calls;
+        std::vector<ApiProfileEntry> entries = collect_api_profile(dropped_calls);
+
+        // Export names are C identifiers, so they never need escaping.
+        std::string ret = "{\n  \"dropped_calls\": " + std::to_string(dropped_calls) + ",\n  \"exports\": [";
+        for (size_t i = 0; i < entries.size(); i++) {
+            const ApiProfileEntry& entry = entries[i];
+            ret += i == 0 ? "\n" : ",\n";
+            ret += "    { \"export\": \"" + entry.export_name + "\"";
+            if (entry.context == ContextId::null()) {
+                ret += ", \"context\": null";
+            }
+            else {
+                ret += ", \"context\": " + std::to_string(entry.context.slot_id);
+            }
+            ret += ", \"calls\": " + std::to_string(entry.calls);
+            ret += ", \"host_time_ns\": " + std::to_string(entry.host_time_ns);
+            ret += ", \"rdram_bytes\": " + std::to_string(entry.rdram_bytes) + " }";
+        }
+        ret += entries.empty() ? "]\n}\n" : "\n  ]\n}\n";
+        return ret;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef __UI_API_PROFILER_H__
+#define __UI_API_PROFILER_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "recomp.h"
+#include "librecomp/overlays.hpp"
+
+#include "core/ui_context.h"
+#include "util/rdram_copy.h"
+
+namespace recompui {
+    // Totals for one export called while a given context was open, which attributes the calls to the mod that owns the context.
+    struct ApiProfileEntry {
+        std::string export_name;
+        ContextId context;
+        uint64_t calls = 0;
+        uint64_t host_time_ns = 0;
+        uint64_t rdram_bytes = 0;
+    };
+
+    // Profiling is off by default, in which case the only cost for each export call is checking the flag.
+    void set_api_profiling_enabled(bool enabled);
+    bool is_api_profiling_enabled();
+    // Discards everything recorded so far. Threads clear their own tables the next time they record a call.
+    void reset_api_profile();
+    // Combines the tables of every thread, sorted by host time with the most expensive first.
+    std::vector<ApiProfileEntry> get_api_profile();
+    std::string get_api_profile_json();
+
+    namespace api_profiler {
+        extern std::atomic<bool> enabled;
+        uint32_t add_export(const char* name);
+        void record_call(uint32_t export_index, ContextId context, std::chrono::steady_clock::duration host_time, uint64_t rdram_bytes);
+    }
+
+    template <recomp_func_t* Func>
+    struct ProfiledExport {
+        static inline uint32_t export_index = 0;
+
+        static void call(uint8_t* rdram, recomp_context* ctx) {
+            if (!api_profiler::enabled.load(std::memory_order_relaxed)) {
+                Func(rdram, ctx);
+                return;
+            }
+
+            ContextId context = try_get_current_context();
+            uint64_t start_bytes = get_rdram_bytes_copied();
+            auto start_time = std::chrono::steady_clock::now();
+            Func(rdram, ctx);
+            auto host_time = std::chrono::steady_clock::now() - start_time;
+
+            // Exports that open a context are attributed to the context they opened.
+            if (context == ContextId::null()) {
+                context = try_get_current_context();
+            }
+
+            api_profiler::record_call(export_index, context, host_time, get_rdram_bytes_copied() - start_bytes);
+        }
+    };
+
+    // Registers a UI export with librecomp through a wrapper that records it in the API profile.
+    template <recomp_func_t* Func>
+    void register_ui_export(const char* name) {
+        ProfiledExport<Func>::export_index = api_profiler::add_export(name);
+        recomp::overlays::register_base_export(name, ProfiledExport<Func>::call);
+    }
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "recompui.h"
+#include "librecomp/overlays.hpp"
+#include "librecomp/helpers.hpp"
+#include "ultramodern/error_handling.hpp"
+
+#include "ui_helpers.h"
+#include "ui_api_strings.h"
+#include "ui_api_profiler.h"
+
+using namespace recompui;
+
+// Handles hold the slot index plus one in the low 16 bits and the slot's generation in the 15 bits above it. Generations
+// change every time a slot is freed, so an element that still remembers an old handle won't mistake a new string for it.
+constexpr uint32_t string_index_bits = 16;
+constexpr uint32_t string_index_mask = (1U << string_index_bits) - 1;
+constexpr uint32_t string_generation_mask = 0x7FFF;
+constexpr size_t max_interned_strings = string_index_mask;
+
+struct InternedString {
+    std::string text;
+    uint32_t refcount = 0;
+    uint32_t generation = 0;
+    bool deduplicated = false;
+};
+
+struct {
+    std::mutex mutex;
+    std::vector<InternedString> strings;
+    std::vector<uint32_t> free_indices;
+    // Strings interned with deduplication enabled, which are shared by every mod that interns the same text.
+    std::unordered_map<std::string, uint32_t> deduplicated_handles;
+} StringState;
+
+static uint32_t make_string_handle(uint32_t index, uint32_t generation) {
+    return (generation << string_index_bits) | (index + 1);
+}
+
+static InternedString* find_interned_string(uint32_t handle) {
+    uint32_t index = (handle & string_index_mask) - 1;
+    uint32_t generation = handle >> string_index_bits;
+
+    if ((handle & string_index_mask) == 0 || index >= StringState.strings.size()) {
+        return nullptr;
+    }
+
+    InternedString& string = StringState.strings[index];
+    if (string.refcount == 0 || string.generation != generation) {
+        return nullptr;
+    }
+
+    return &string;
+}
+
+std::string recompui::get_interned_string(uint32_t handle) {
+    std::lock_guard lock{StringState.mutex};
+    InternedString* string = find_interned_string(handle);
+
+    if (string == nullptr) {
+        recompui::message_box("Fatal error in mod - attempted to use an interned string that doesn't exist");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    return string->text;
+}
+
+void recompui_intern_string(uint8_t* rdram, recomp_context* ctx) {
+    std::string text = decode_string(rdram, _arg<0, PTR(char)>(rdram, ctx));
+    bool deduplicate = _arg<1, uint32_t>(rdram, ctx) != 0;
+
+    std::lock_guard lock{StringState.mutex};
+
+    if (deduplicate) {
+        auto find_it = StringState.deduplicated_handles.find(text);
+        if (find_it != StringState.deduplicated_handles.end()) {
+            find_interned_string(find_it->second)->refcount++;
+            _return<uint32_t>(ctx, find_it->second);
+            return;
+        }
+    }
+
+    uint32_t index;
+    if (!StringState.free_indices.empty()) {
+        index = StringState.free_indices.back();
+        StringState.free_indices.pop_back();
+    }
+    else if (StringState.strings.size() < max_interned_strings) {
+        index = static_cast<uint32_t>(StringState.strings.size());
+        StringState.strings.emplace_back();
+    }
+    else {
+        recompui::message_box("Fatal error in mod - too many interned strings");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    InternedString& string = StringState.strings[index];
+    uint32_t handle = make_string_handle(index, string.generation);
+    string.refcount = 1;
+    string.deduplicated = deduplicate;
+
+    if (deduplicate) {
+        StringState.deduplicated_handles.emplace(text, handle);
+    }
+
+    string.text = std::move(text);
+    _return<uint32_t>(ctx, handle);
+}
+
+void recompui_release_string(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t handle = _arg<0, uint32_t>(rdram, ctx);
+
+    std::lock_guard lock{StringState.mutex};
+    InternedString* string = find_interned_string(handle);
+
+    if (string == nullptr) {
+        recompui::message_box("Fatal error in mod - attempted to release an interned string that doesn't exist");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    if (--string->refcount > 0) {
+        return;
+    }
+
+    if (string->deduplicated) {
+        StringState.deduplicated_handles.erase(string->text);
+    }
+
+    string->text = {};
+    string->deduplicated = false;
+    string->generation = (string->generation + 1) & string_generation_mask;
+    StringState.free_indices.emplace_back((handle & string_index_mask) - 1);
+}
+
+#define REGISTER_FUNC(name) recompui::register_ui_export<name>(#name)
+
+void recompui::register_ui_string_exports() {
+    REGISTER_FUNC(recompui_intern_string);
+    REGISTER_FUNC(recompui_release_string);
+}
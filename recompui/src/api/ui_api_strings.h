@@ -0,0 +1,20 @@
+#ifndef __UI_API_STRINGS_H__
+#define __UI_API_STRINGS_H__
+
+#include <cstdint>
+#include <string>
+
+#include "recomp.h"
+
+namespace recompui {
+    // Interned string handles are always below the start of KSEG0, so text arguments can hold either a handle or a pointer to a string.
+    inline bool is_interned_string_handle(PTR(char) str) {
+        return str != 0 && static_cast<uint32_t>(str) < 0x80000000U;
+    }
+
+    // Gets the text of an interned string. Ends the game with an error if the handle doesn't refer to a live string.
+    std::string get_interned_string(uint32_t handle);
+    void register_ui_string_exports();
+}
+
+#endif
@@ -0,0 +1,304 @@
+#include <cstring>
+
+#include "recompui.h"
+#include "librecomp/overlays.hpp"
+#include "librecomp/helpers.hpp"
+#include "librecomp/addresses.hpp"
+#include "ultramodern/error_handling.hpp"
+
+#include "ui_helpers.h"
+#include "ui_api_style.h"
+#include "ui_api_profiler.h"
+#include "elements/ui_style.h"
+
+using namespace recompui;
+
+static float command_float(const StyleCommand& command) {
+    float ret;
+    memcpy(&ret, &command.value, sizeof(ret));
+    return ret;
+}
+
+static Unit command_unit(const StyleCommand& command) {
+    return static_cast<Unit>(command.unit);
+}
+
+static Color command_color(const StyleCommand& command) {
+    return Color{
+        static_cast<uint8_t>(command.value >> 24),
+        static_cast<uint8_t>(command.value >> 16),
+        static_cast<uint8_t>(command.value >> 8),
+        static_cast<uint8_t>(command.value >> 0)
+    };
+}
+
+bool recompui::is_valid_style_opcode(uint32_t opcode) {
+    return opcode <= static_cast<uint32_t>(StyleOpcode::TabIndex);
+}
+
+bool recompui::apply_style_command(Style* resource, const StyleCommand& command) {
+    switch (static_cast<StyleOpcode>(command.opcode)) {
+    case StyleOpcode::Visibility:
+        resource->set_visibility(static_cast<Visibility>(command.value));
+        break;
+    case StyleOpcode::Position:
+        resource->set_position(static_cast<Position>(command.value));
+        break;
+    case StyleOpcode::Left:
+        resource->set_left(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::Top:
+        resource->set_top(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::Right:
+        resource->set_right(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::Bottom:
+        resource->set_bottom(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::Width:
+        resource->set_width(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::WidthAuto:
+        resource->set_width_auto();
+        break;
+    case StyleOpcode::Height:
+        resource->set_height(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::HeightAuto:
+        resource->set_height_auto();
+        break;
+    case StyleOpcode::MinWidth:
+        resource->set_min_width(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::MinHeight:
+        resource->set_min_height(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::MaxWidth:
+        resource->set_max_width(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::MaxHeight:
+        resource->set_max_height(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::Padding:
+        resource->set_padding(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::PaddingLeft:
+        resource->set_padding_left(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::PaddingTop:
+        resource->set_padding_top(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::PaddingRight:
+        resource->set_padding_right(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::PaddingBottom:
+        resource->set_padding_bottom(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::Margin:
+        resource->set_margin(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::MarginLeft:
+        resource->set_margin_left(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::MarginTop:
+        resource->set_margin_top(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::MarginRight:
+        resource->set_margin_right(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::MarginBottom:
+        resource->set_margin_bottom(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::MarginAuto:
+        resource->set_margin_auto();
+        break;
+    case StyleOpcode::MarginLeftAuto:
+        resource->set_margin_left_auto();
+        break;
+    case StyleOpcode::MarginTopAuto:
+        resource->set_margin_top_auto();
+        break;
+    case StyleOpcode::MarginRightAuto:
+        resource->set_margin_right_auto();
+        break;
+    case StyleOpcode::MarginBottomAuto:
+        resource->set_margin_bottom_auto();
+        break;
+    case StyleOpcode::BorderWidth:
+        resource->set_border_width(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderLeftWidth:
+        resource->set_border_left_width(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderTopWidth:
+        resource->set_border_top_width(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderRightWidth:
+        resource->set_border_right_width(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderBottomWidth:
+        resource->set_border_bottom_width(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderRadius:
+        resource->set_border_radius(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderTopLeftRadius:
+        resource->set_border_top_left_radius(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderTopRightRadius:
+        resource->set_border_top_right_radius(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderBottomLeftRadius:
+        resource->set_border_bottom_left_radius(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BorderBottomRightRadius:
+        resource->set_border_bottom_right_radius(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::BackgroundColor:
+        resource->set_background_color(command_color(command));
+        break;
+    case StyleOpcode::BorderColor:
+        resource->set_border_color(command_color(command));
+        break;
+    case StyleOpcode::BorderLeftColor:
+        resource->set_border_left_color(command_color(command));
+        break;
+    case StyleOpcode::BorderTopColor:
+        resource->set_border_top_color(command_color(command));
+        break;
+    case StyleOpcode::BorderRightColor:
+        resource->set_border_right_color(command_color(command));
+        break;
+    case StyleOpcode::BorderBottomColor:
+        resource->set_border_bottom_color(command_color(command));
+        break;
+    case StyleOpcode::Color:
+        resource->set_color(command_color(command));
+        break;
+    case StyleOpcode::Cursor:
+        resource->set_cursor(static_cast<Cursor>(command.value));
+        break;
+    case StyleOpcode::Opacity:
+        resource->set_opacity(command_float(command));
+        break;
+    case StyleOpcode::Display:
+        resource->set_display(static_cast<Display>(command.value));
+        break;
+    case StyleOpcode::JustifyContent:
+        resource->set_justify_content(static_cast<JustifyContent>(command.value));
+        break;
+    case StyleOpcode::FlexGrow:
+        resource->set_flex_grow(command_float(command));
+        break;
+    case StyleOpcode::FlexShrink:
+        resource->set_flex_shrink(command_float(command));
+        break;
+    case StyleOpcode::FlexBasisAuto:
+        resource->set_flex_basis_auto();
+        break;
+    case StyleOpcode::FlexBasis:
+        resource->set_flex_basis(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::FlexDirection:
+        resource->set_flex_direction(static_cast<FlexDirection>(command.value));
+        break;
+    case StyleOpcode::AlignItems:
+        resource->set_align_items(static_cast<AlignItems>(command.value));
+        break;
+    case StyleOpcode::Overflow:
+        resource->set_overflow(static_cast<Overflow>(command.value));
+        break;
+    case StyleOpcode::OverflowX:
+        resource->set_overflow_x(static_cast<Overflow>(command.value));
+        break;
+    case StyleOpcode::OverflowY:
+        resource->set_overflow_y(static_cast<Overflow>(command.value));
+        break;
+    case StyleOpcode::FontSize:
+        resource->set_font_size(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::LetterSpacing:
+        resource->set_letter_spacing(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::LineHeight:
+        resource->set_line_height(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::FontStyle:
+        resource->set_font_style(static_cast<FontStyle>(command.value));
+        break;
+    case StyleOpcode::FontWeight:
+        resource->set_font_weight(command.value);
+        break;
+    case StyleOpcode::TextAlign:
+        resource->set_text_align(static_cast<TextAlign>(command.value));
+        break;
+    case StyleOpcode::Gap:
+        resource->set_gap(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::RowGap:
+        resource->set_row_gap(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::ColumnGap:
+        resource->set_column_gap(command_float(command), command_unit(command));
+        break;
+    case StyleOpcode::Drag:
+        resource->set_drag(static_cast<Drag>(command.value));
+        break;
+    case StyleOpcode::TabIndex:
+        resource->set_tab_index(static_cast<TabIndex>(command.value));
+        break;
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+static bool is_valid_style_command_buffer(PTR(void) commands_ptr, uint32_t command_count) {
+    uint32_t address_u32 = static_cast<uint32_t>(commands_ptr);
+    uint64_t buffer_size = static_cast<uint64_t>(command_count) * sizeof(StyleCommand);
+    return address_u32 >= 0x80000000U && buffer_size <= recomp::mem_size &&
+        address_u32 - 0x80000000U <= recomp::mem_size - buffer_size;
+}
+
+// Applies a buffer of style commands to a style or element in a single call, which replaces one export call per
+// property when building large UIs. Takes the resource, a word aligned pointer to the commands and the command count.
+void recompui_apply_style_commands(uint8_t* rdram, recomp_context* ctx) {
+    Style* resource = arg_style<0>(rdram, ctx);
+    PTR(void) commands_ptr = _arg<1, PTR(void)>(rdram, ctx);
+    uint32_t command_count = _arg<2, uint32_t>(rdram, ctx);
+
+    if (resource == nullptr) {
+        recompui::message_box("Fatal error in mod - attempted to apply style commands to a resource not found in context");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    if (!is_valid_style_command_buffer(commands_ptr, command_count)) {
+        recompui::message_box("Fatal error in mod - style command buffer is null or outside of rdram");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    if ((commands_ptr & 3) != 0) {
+        recompui::message_box("Fatal error in mod - style command buffer is not word aligned");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    const StyleCommand* commands = TO_PTR(StyleCommand, commands_ptr);
+    for (uint32_t i = 0; i < command_count; i++) {
+        if (!apply_style_command(resource, commands[i])) {
+            recompui::message_box("Fatal error in mod - invalid style command opcode");
+            assert(false);
+            ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+        }
+    }
+}
+
+#define REGISTER_FUNC(name) recompui::register_ui_export<name>(#name)
+
+void recompui::register_ui_style_exports() {
+    REGISTER_FUNC(recompui_apply_style_commands);
+}
@@ -0,0 +1,99 @@
+#ifndef __UI_API_STYLE_H__
+#define __UI_API_STYLE_H__
+
+#include <cstdint>
+
+namespace recompui {
+    class Style;
+
+    // Opcodes for recompui_apply_style_commands.
+    enum class StyleOpcode : uint32_t {
+        Visibility = 0,
+        Position = 1,
+        Left = 2,
+        Top = 3,
+        Right = 4,
+        Bottom = 5,
+        Width = 6,
+        WidthAuto = 7,
+        Height = 8,
+        HeightAuto = 9,
+        MinWidth = 10,
+        MinHeight = 11,
+        MaxWidth = 12,
+        MaxHeight = 13,
+        Padding = 14,
+        PaddingLeft = 15,
+        PaddingTop = 16,
+        PaddingRight = 17,
+        PaddingBottom = 18,
+        Margin = 19,
+        MarginLeft = 20,
+        MarginTop = 21,
+        MarginRight = 22,
+        MarginBottom = 23,
+        MarginAuto = 24,
+        MarginLeftAuto = 25,
+        MarginTopAuto = 26,
+        MarginRightAuto = 27,
+        MarginBottomAuto = 28,
+        BorderWidth = 29,
+        BorderLeftWidth = 30,
+        BorderTopWidth = 31,
+        BorderRightWidth = 32,
+        BorderBottomWidth = 33,
+        BorderRadius = 34,
+        BorderTopLeftRadius = 35,
+        BorderTopRightRadius = 36,
+        BorderBottomLeftRadius = 37,
+        BorderBottomRightRadius = 38,
+        BackgroundColor = 39,
+        BorderColor = 40,
+        BorderLeftColor = 41,
+        BorderTopColor = 42,
+        BorderRightColor = 43,
+        BorderBottomColor = 44,
+        Color = 45,
+        Cursor = 46,
+        Opacity = 47,
+        Display = 48,
+        JustifyContent = 49,
+        FlexGrow = 50,
+        FlexShrink = 51,
+        FlexBasisAuto = 52,
+        FlexBasis = 53,
+        FlexDirection = 54,
+        AlignItems = 55,
+        Overflow = 56,
+        OverflowX = 57,
+        OverflowY = 58,
+        FontSize = 59,
+        LetterSpacing = 60,
+        LineHeight = 61,
+        FontStyle = 62,
+        FontWeight = 63,
+        TextAlign = 64,
+        Gap = 65,
+        RowGap = 66,
+        ColumnGap = 67,
+        Drag = 68,
+        TabIndex = 69,
+    };
+
+    // A single record in a style command buffer. Every field is a full word, so the records can be read straight out of
+    // rdram without byteswapping. The value holds a float, an enum value or an RGBA color packed as 0xRRGGBBAA depending on
+    // the opcode, and the unit is ignored by opcodes that don't take one.
+    struct StyleCommand {
+        uint32_t opcode;
+        uint32_t unit;
+        uint32_t value;
+    };
+    static_assert(sizeof(StyleCommand) == 12);
+
+    bool is_valid_style_opcode(uint32_t opcode);
+    // Applies a single style command, returning false if its opcode isn't valid.
+    bool apply_style_command(Style* resource, const StyleCommand& command);
+    void register_ui_style_exports();
+}
+
+#endif
@@ -0,0 +1,281 @@
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "recompui.h"
+#include "librecomp/overlays.hpp"
+#include "librecomp/helpers.hpp"
+#include "ultramodern/error_handling.hpp"
+
+#include "ui_helpers.h"
+#include "ui_api_templates.h"
+#include "ui_api_profiler.h"
+#include "ui_api_style.h"
+#include "elements/ui_button.h"
+#include "elements/ui_label.h"
+#include "elements/ui_slider.h"
+#include "elements/ui_span.h"
+#include "elements/ui_text_input.h"
+
+using namespace recompui;
+
+// Element kinds for template nodes.
+enum class TemplateElementKind : uint32_t {
+    Element = 0,
+    Label = 1,
+    Button = 2,
+    Span = 3,
+    TextInput = 4,
+    PasswordInput = 5,
+    Slider = 6,
+};
+
+constexpr uint32_t template_no_index = 0xFFFFFFFF;
+constexpr uint32_t max_template_names = 4096;
+
+// A node in a serialized template as laid out by the mod. Like style commands, every field is a full word so the nodes
+// can be read straight out of rdram. Parents must come before their children, and nodes without a parent become the roots
+// of the instantiated subtree. The variant is the ButtonStyle, LabelStyle or SliderType for kinds that take one, and the
+// text is either a string pointer or an interned string handle. Named nodes write their ResourceId to the given index of
+// the output table when the template is instantiated.
+struct TemplateNodeRecord {
+    uint32_t kind;
+    uint32_t parent;
+    uint32_t variant;
+    PTR(char) text;
+    uint32_t first_style;
+    uint32_t style_count;
+    uint32_t name;
+    PTR(void) callback;
+    PTR(void) userdata;
+};
+static_assert(sizeof(TemplateNodeRecord) == 36);
+
+struct TemplateNode {
+    TemplateElementKind kind;
+    uint32_t parent;
+    uint32_t variant;
+    std::string text;
+    uint32_t first_style;
+    uint32_t style_count;
+    uint32_t name;
+    PTR(void) callback;
+    PTR(void) userdata;
+};
+
+// Templates are decoded and validated when they're registered, so instantiating one never reads from rdram.
+struct UITemplate {
+    std::vector<TemplateNode> nodes;
+    std::vector<StyleCommand> styles;
+};
+
+struct {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<UITemplate>> templates;
+} TemplateState;
+
+static void template_error(const char* message) {
+    recompui::message_box(message);
+    assert(false);
+    ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+}
+
+static bool kind_has_text(TemplateElementKind kind) {
+    switch (kind) {
+    case TemplateElementKind::Label:
+    case TemplateElementKind::Button:
+    case TemplateElementKind::Span:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static Element* create_template_element(ContextId ui_context, Element* parent, const TemplateNode& node) {
+    // Roots are built detached and attached once the whole subtree is done.
+    if (parent == nullptr) {
+        switch (node.kind) {
+        case TemplateElementKind::Element:
+            return ui_context.create_detached_element<Element>();
+        case TemplateElementKind::Label:
+            return ui_context.create_detached_element<Label>(node.text, static_cast<LabelStyle>(node.variant));
+        case TemplateElementKind::Button:
+            return ui_context.create_detached_element<Button>(node.text, static_cast<ButtonStyle>(node.variant));
+        case TemplateElementKind::Span:
+            return ui_context.create_detached_element<Span>(node.text);
+        case TemplateElementKind::TextInput:
+            return ui_context.create_detached_element<TextInput>();
+        case TemplateElementKind::PasswordInput:
+            return ui_context.create_detached_element<TextInput>(false);
+        case TemplateElementKind::Slider:
+            return ui_context.create_detached_element<Slider>(static_cast<SliderType>(node.variant));
+        }
+    }
+    else {
+        switch (node.kind) {
+        case TemplateElementKind::Element:
+            return ui_context.create_element<Element>(parent);
+        case TemplateElementKind::Label:
+            return ui_context.create_element<Label>(parent, node.text, static_cast<LabelStyle>(node.variant));
+        case TemplateElementKind::Button:
+            return ui_context.create_element<Button>(parent, node.text, static_cast<ButtonStyle>(node.variant));
+        case TemplateElementKind::Span:
+            return ui_context.create_element<Span>(parent, node.text);
+        case TemplateElementKind::TextInput:
+            return ui_context.create_element<TextInput>(parent);
+        case TemplateElementKind::PasswordInput:
+            return ui_context.create_element<TextInput>(parent, false);
+        case TemplateElementKind::Slider:
+            return ui_context.create_element<Slider>(parent, static_cast<SliderType>(node.variant));
+        }
+    }
+
+    assert(false && "Unknown template element kind.");
+    return nullptr;
+}
+
+void recompui_register_template(uint8_t* rdram, recomp_context* ctx) {
+    PTR(void) nodes_ptr = _arg<0, PTR(void)>(rdram, ctx);
+    uint32_t node_count = _arg<1, uint32_t>(rdram, ctx);
+    PTR(void) styles_ptr = _arg<2, PTR(void)>(rdram, ctx);
+    uint32_t style_count = _arg<3, uint32_t>(rdram, ctx);
+
+    if ((nodes_ptr & 3) != 0 || (styles_ptr & 3) != 0) {
+        template_error("Fatal error in mod - template buffers are not word aligned");
+    }
+
+    const TemplateNodeRecord* node_records = TO_PTR(TemplateNodeRecord, nodes_ptr);
+    const StyleCommand* style_records = TO_PTR(StyleCommand, styles_ptr);
+
+    auto ui_template = std::make_unique<UITemplate>();
+    ui_template->styles.assign(style_records, style_records + style_count);
+    for (const StyleCommand& command : ui_template->styles) {
+        if (!is_valid_style_opcode(command.opcode)) {
+            template_error("Fatal error in mod - invalid style command opcode in template");
+        }
+    }
+
+    std::vector<bool> names_used;
+    ui_template->nodes.reserve(node_count);
+    for (uint32_t i = 0; i < node_count; i++) {
+        const TemplateNodeRecord& record = node_records[i];
+
+        if (record.kind > static_cast<uint32_t>(TemplateElementKind::Slider)) {
+            template_error("Fatal error in mod - invalid element kind in template");
+        }
+
+        if (record.parent != template_no_index && record.parent >= i) {
+            template_error("Fatal error in mod - template node's parent must come before it");
+        }
+
+        if (record.first_style > style_count || record.style_count > style_count - record.first_style) {
+            template_error("Fatal error in mod - template node's styles are out of bounds");
+        }
+
+        if (record.name != template_no_index) {
+            if (record.name >= max_template_names) {
+                template_error("Fatal error in mod - template node name index is too large");
+            }
+
+            if (record.name >= names_used.size()) {
+                names_used.resize(record.name + 1);
+            }
+
+            if (names_used[record.name]) {
+                template_error("Fatal error in mod - template uses the same name index for multiple nodes");
+            }
+            names_used[record.name] = true;
+        }
+
+        TemplateElementKind kind = static_cast<TemplateElementKind>(record.kind);
+        if (record.text != 0 && !kind_has_text(kind)) {
+            template_error("Fatal error in mod - template node of a kind that can't have text was given text");
+        }
+
+        ui_template->nodes.emplace_back(TemplateNode{
+            .kind = kind,
+            .parent = record.parent,
+            .variant = record.variant,
+            .text = record.text != 0 ? decode_text(rdram, record.text) : std::string{},
+            .first_style = record.first_style,
+            .style_count = record.style_count,
+            .name = record.name,
+            .callback = record.callback,
+            .userdata = record.userdata
+        });
+    }
+
+    std::lock_guard lock{TemplateState.mutex};
+    TemplateState.templates.emplace_back(std::move(ui_template));
+
+    // Template ids start at 1 so that 0 is never a valid template.
+    _return<uint32_t>(ctx, static_cast<uint32_t>(TemplateState.templates.size()));
+}
+
+void recompui_instantiate_template(uint8_t* rdram, recomp_context* ctx) {
+    ContextId ui_context = get_context(rdram, ctx);
+    ResourceOriginScope origin{ __func__ };
+    Element* parent = arg_element<1>(rdram, ctx, ui_context);
+    uint32_t template_id = _arg<2, uint32_t>(rdram, ctx);
+    PTR(u32) names_out = _arg<3, PTR(u32)>(rdram, ctx);
+
+    const UITemplate* ui_template = nullptr;
+    {
+        std::lock_guard lock{TemplateState.mutex};
+        if (template_id != 0 && template_id <= TemplateState.templates.size()) {
+            ui_template = TemplateState.templates[template_id - 1].get();
+        }
+    }
+
+    if (ui_template == nullptr) {
+        template_error("Fatal error in mod - attempted to instantiate a template that doesn't exist");
+    }
+
+    std::vector<Element*> elements;
+    elements.reserve(ui_template->nodes.size());
+    for (const TemplateNode& node : ui_template->nodes) {
+        Element* node_parent = node.parent != template_no_index ? elements[node.parent] : nullptr;
+        Element* element = create_template_element(ui_context, node_parent, node);
+
+        for (uint32_t i = 0; i < node.style_count; i++) {
+            apply_style_command(element, ui_template->styles[node.first_style + i]);
+        }
+
+        if (node.callback != 0) {
+            element->register_callback(ui_context, node.callback, node.userdata);
+        }
+
+        if (node.name != template_no_index && names_out != 0) {
+            MEM_W(sizeof(uint32_t) * node.name, names_out) = element->get_resource_id().slot_id;
+        }
+
+        elements.emplace_back(element);
+    }
+
+    // Attach the finished subtrees, which is the only point where the live document is touched. Without a parent the
+    // roots stay detached so the mod can attach them later.
+    ResourceId first_root = ResourceId::null();
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (ui_template->nodes[i].parent != template_no_index) {
+            continue;
+        }
+
+        if (parent != nullptr) {
+            ui_context.attach_element(elements[i], parent);
+        }
+
+        if (first_root == ResourceId::null()) {
+            first_root = elements[i]->get_resource_id();
+        }
+    }
+
+    return_resource(ctx, first_root);
+}
+
+#define REGISTER_FUNC(name) recompui::register_ui_export<name>(#name)
+
+void recompui::register_ui_template_exports() {
+    REGISTER_FUNC(recompui_register_template);
+    REGISTER_FUNC(recompui_instantiate_template);
+}
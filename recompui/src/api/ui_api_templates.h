@@ -0,0 +1,10 @@
+#ifndef __UI_API_TEMPLATES_H__
+#define __UI_API_TEMPLATES_H__
+
+#include <cstdint>
+
+namespace recompui {
+    void register_ui_template_exports();
+}
+
+#endif
@@ -9,6 +9,8 @@
 #include "elements/ui_types.h"
 #include "core/ui_context.h"
 #include "core/ui_resource.h"
+#include "util/rdram_copy.h"
+#include "ui_api_strings.h"
 
 namespace recompui {
 
@@ -126,9 +128,7 @@ inline void return_resource(recomp_context* ctx, ResourceId resource) {
 inline void return_string(uint8_t* rdram, recomp_context* ctx, const std::string& ret) {
     gpr addr = (reinterpret_cast<uint8_t*>(recomp::alloc(rdram, ret.size() + 1)) - rdram) + 0xFFFFFFFF80000000ULL;
 
-    for (size_t i = 0; i < ret.size(); i++) {
-        MEM_B(i, addr) = ret[i];
-    }
+    copy_to_rdram(rdram, addr, ret.data(), ret.size());
     MEM_B(ret.size(), addr) = '\x00';
     
     _return<PTR(char)>(ctx, addr);
@@ -136,19 +136,26 @@ inline void return_string(uint8_t* rdram, recomp_context* ctx, const std::string
 
 inline std::string decode_string(uint8_t* rdram, PTR(char) str) {
     // Get the length of the byteswapped string.
-    size_t len = 0;
-    while (MEM_B(str, len) != 0x00) {
-        len++;
-    }
+    size_t len = rdram_strlen(rdram, str);
+
+    std::string ret(len, '\0');
+    copy_from_rdram(rdram, ret.data(), str, len);
 
-    std::string ret{};
-    ret.reserve(len + 1);
+    return ret;
+}
 
-    for (size_t i = 0; i < len; i++) {
-        ret += (char)MEM_B(str, i);
+// Decodes a text argument, which holds either a pointer to a string or an interned string handle.
+inline std::string decode_text(uint8_t* rdram, PTR(char) str) {
+    if (is_interned_string_handle(str)) {
+        return get_interned_string(static_cast<uint32_t>(str));
     }
 
-    return ret;
+    return decode_string(rdram, str);
+}
+
+template <int arg_index>
+std::string arg_text(uint8_t* rdram, recomp_context* ctx) {
+    return decode_text(rdram, _arg<arg_index, PTR(char)>(rdram, ctx));
 }
 }
 
@@ -90,18 +90,21 @@ namespace recompui {
             bool active = std::get<EventFocus>(e.variant).active;
             set_style_enabled(focus_state, active);
             if (active) {
-                queue_update();
+                // Same pulse as get_pulse_color(750).
+                animate(
+                    AnimationTrack::tween(AnimatedProperty::Color,
+                        theme::get_theme_color(theme::color::SecondaryL),
+                        theme::get_theme_color(theme::color::Secondary),
+                        375.0f)
+                    .set_repeat(AnimationRepeat::Yoyo)
+                    .set_synchronized(true),
+                    &focus_style);
             }
-            break;
-        }
-        case EventType::Update:
-            if (is_style_enabled(focus_state)) {
-                recompui::Color pulse_color = recompui::get_pulse_color(750);
-                focus_style.set_color(pulse_color);
-                apply_styles();
-                queue_update();
+            else {
+                stop_animations(&focus_style);
             }
             break;
+        }
         default:
             assert(false && "Unknown event type.");
             break;
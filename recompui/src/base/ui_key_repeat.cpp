@@ -0,0 +1,85 @@
+#include "ui_key_repeat.h"
+
+#include <algorithm>
+
+namespace recompui {
+    KeyRepeatScheduler::KeyRepeatScheduler() : KeyRepeatScheduler(Settings{}) {}
+
+    KeyRepeatScheduler::KeyRepeatScheduler(const Settings &settings, now_func_t now) : settings(settings), now(std::move(now)) {}
+
+    void KeyRepeatScheduler::press(int32_t device, int key) {
+        clock::time_point first_repeat_time = now() + settings.start_delay;
+
+        for (Timer &timer : timers) {
+            if (timer.device == device) {
+                timer.key = key;
+                timer.first_repeat_time = first_repeat_time;
+                timer.next_repeat_time = first_repeat_time;
+                return;
+            }
+        }
+
+        timers.emplace_back(Timer{ device, key, first_repeat_time, first_repeat_time });
+    }
+
+    void KeyRepeatScheduler::release(int32_t device, int key) {
+        std::erase_if(timers, [device, key](const Timer &timer) {
+            return timer.device == device && timer.key == key;
+        });
+    }
+
+    void KeyRepeatScheduler::release_device(int32_t device) {
+        std::erase_if(timers, [device](const Timer &timer) {
+            return timer.device == device;
+        });
+    }
+
+    void KeyRepeatScheduler::release_all() {
+        timers.clear();
+    }
+
+    KeyRepeatScheduler::clock::duration KeyRepeatScheduler::get_repeat_rate(const Timer &timer) const {
+        clock::duration repeating_time = timer.next_repeat_time - timer.first_repeat_time;
+        if (repeating_time <= settings.acceleration_delay) {
+            return settings.repeat_rate;
+        }
+
+        if (settings.acceleration_time <= clock::duration::zero()) {
+            return settings.fastest_repeat_rate;
+        }
+
+        double factor = std::min(std::chrono::duration<double>(repeating_time - settings.acceleration_delay) / std::chrono::duration<double>(settings.acceleration_time), 1.0);
+        return settings.repeat_rate - std::chrono::duration_cast<clock::duration>((settings.repeat_rate - settings.fastest_repeat_rate) * factor);
+    }
+
+    void KeyRepeatScheduler::poll(const std::function<void(int key)> &on_repeat) {
+        clock::time_point cur_time = now();
+
+        // Drop repeats that are too far behind so a stall doesn't cause a burst of inputs.
+        // The limit is recomputed as the timer advances, as the repeat rate can speed up while catching up.
+        for (Timer &timer : timers) {
+            while (timer.next_repeat_time < cur_time - get_repeat_rate(timer) * settings.max_catch_up_repeats) {
+                timer.next_repeat_time += get_repeat_rate(timer);
+            }
+        }
+
+        while (true) {
+            // Find the timer whose next repeat is the earliest due.
+            Timer *next_timer = nullptr;
+            for (Timer &timer : timers) {
+                if (timer.next_repeat_time <= cur_time && (next_timer == nullptr || timer.next_repeat_time < next_timer->next_repeat_time)) {
+                    next_timer = &timer;
+                }
+            }
+
+            if (next_timer == nullptr) {
+                break;
+            }
+
+            // Advance the timer before calling the callback, as the callback may press or release keys.
+            int key = next_timer->key;
+            next_timer->next_repeat_time += get_repeat_rate(*next_timer);
+            on_repeat(key);
+        }
+    }
+} // namespace recompui
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace recompui {
+    // Generates repeated key presses for held controller buttons and stick directions. Every device has its own timer
+    // that repeats the latest key pressed on it, so holding two directions on one controller only repeats the newer one.
+    // Repeats are scheduled at fixed points in time instead of once per frame, so the number of repeats only depends on
+    // how long the input was held. Repeats speed up the longer an input is held.
+    class KeyRepeatScheduler {
+    public:
+        using clock = std::chrono::steady_clock;
+        using now_func_t = std::function<clock::time_point()>;
+
+        struct Settings {
+            // Time between the initial press and the first repeat.
+            clock::duration start_delay = std::chrono::milliseconds{500};
+            // Time between repeats before and after accelerating.
+            clock::duration repeat_rate = std::chrono::milliseconds{50};
+            clock::duration fastest_repeat_rate = std::chrono::milliseconds{25};
+            // How long repeats have to run before they start speeding up, and how long they take to reach the fastest rate.
+            clock::duration acceleration_delay = std::chrono::milliseconds{1500};
+            clock::duration acceleration_time = std::chrono::milliseconds{1500};
+            // Limits the repeats sent for one input in a single poll after a long stall, after which missed repeats are dropped.
+            uint32_t max_catch_up_repeats = 4;
+        };
+
+        KeyRepeatScheduler();
+        // The clock can be replaced to drive the scheduler deterministically.
+        KeyRepeatScheduler(const Settings &settings, now_func_t now = &clock::now);
+        // Starts repeating a key for a device, replacing any key that device was already repeating.
+        void press(int32_t device, int key);
+        // Stops repeating a key for a device. Does nothing if the device is repeating a different key.
+        void release(int32_t device, int key);
+        // Stops repeating for a device, e.g. when it's disconnected and won't send its button releases.
+        void release_device(int32_t device);
+        void release_all();
+        bool is_repeating() const { return !timers.empty(); }
+        // Sends every repeat that's due, in the order they were due.
+        void poll(const std::function<void(int key)> &on_repeat);
+    private:
+        struct Timer {
+            int32_t device;
+            int key;
+            clock::time_point first_repeat_time;
+            clock::time_point next_repeat_time;
+        };
+
+        Settings settings;
+        now_func_t now;
+        std::vector<Timer> timers;
+
+        clock::duration get_repeat_rate(const Timer &timer) const;
+    };
+} // namespace recompui
@@ -54,22 +54,30 @@ namespace recompui {
         
         void process_event(const Event& e) override {
             switch (e.type) {
-            case EventType::Focus:
-                set_style_enabled(focus_state, std::get<EventFocus>(e.variant).active);
+            case EventType::Focus: {
+                bool active = std::get<EventFocus>(e.variant).active;
+                set_style_enabled(focus_state, active);
                 scroll_into_view(!instant_scroll);
                 instant_scroll = false;
-                queue_update();
+                if (active) {
+                    // Same pulse as get_pulse_color(750).
+                    animate(
+                        AnimationTrack::tween(AnimatedProperty::Color,
+                            theme::get_theme_color(theme::color::SecondaryL),
+                            theme::get_theme_color(theme::color::Secondary),
+                            375.0f)
+                        .set_repeat(AnimationRepeat::Yoyo)
+                        .set_synchronized(true),
+                        &pulsing_style);
+                }
+                else {
+                    stop_animations(&pulsing_style);
+                }
                 break;
+            }
             case EventType::Hover:
                 set_style_enabled(hover_state, std::get<EventHover>(e.variant).active);
                 break;
-            case EventType::Update:
-                if (is_style_enabled(focus_state)) {
-                    pulsing_style.set_color(recompui::get_pulse_color(750));
-                    apply_styles();
-                    queue_update();
-                }
-                break;
             case EventType::Click:
                 on_select_option(mode_id);
                 break;
@@ -79,7 +87,7 @@ namespace recompui {
         }
         std::string_view get_type_name() override { return "GameModeOption"; }
     public:
-        GameModeOption(ResourceId rid, Element* parent, on_select_option_t on_select_option, const std::string &mode_id, const std::string &name, const std::string &thumbnail) : Element(rid, parent, Events(EventType::Update, EventType::Click, EventType::Hover, EventType::Focus)) {
+        GameModeOption(ResourceId rid, Element* parent, on_select_option_t on_select_option, const std::string &mode_id, const std::string &name, const std::string &thumbnail) : Element(rid, parent, Events(EventType::Click, EventType::Hover, EventType::Focus)) {
             ContextId context = get_current_context();
             this->on_select_option = on_select_option;
             this->mode_id = mode_id;
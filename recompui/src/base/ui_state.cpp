@@ -4,7 +4,10 @@
 #else
 #include <SDL2/SDL_video.h>
 #endif
+#include <atomic>
 #include <chrono>
+#include <optional>
+#include <vector>
 
 #include "rt64_render_hooks.h"
 
@@ -25,6 +28,7 @@
 #include "librecomp/game.hpp"
 
 #include "base/ui_launcher.h"
+#include "base/ui_key_repeat.h"
 #include "composites/ui_mod_menu.h"
 #include "composites/ui_mod_installer.h"
 #include "composites/ui_assign_players_modal.h"
@@ -134,6 +138,8 @@ namespace recompui {
     public:
         UiEventListener(event_handler_t* handler, Rml::String&& param) : handler_(handler), param_(std::move(param)) {}
         void ProcessEvent(Rml::Event& event) override {
+            // Legacy handlers expect no context to be open.
+            release_event_dispatch_context();
             handler_(param_, event);
         }
     };
@@ -205,6 +211,7 @@ struct ContextDetails {
 class UIState {
     bool mouse_is_active_changed = false;
     std::vector<ContextDetails> shown_contexts{};
+    std::vector<recompui::ContextId> relayout_contexts{};
 public:
     bool mouse_is_active_initialized = false;
     bool mouse_is_active = false;
@@ -322,10 +329,12 @@ public:
             if (mouse_is_active) {
                 if (!window_el->HasAttribute("mouse-active")) {
                     window_el->SetAttribute("mouse-active", true);
+                    top_mouse_context().mark_layout_dirty();
                 }
             }
             else if (window_el->HasAttribute("mouse-active")) {
                 window_el->RemoveAttribute("mouse-active");
+                top_mouse_context().mark_layout_dirty();
             }
         }
     }
@@ -390,6 +399,7 @@ public:
 
         document->PullToFront();
         document->Show();
+        context.mark_layout_dirty();
 
         if (!mouse_is_active) {
             recompui::Element* default_element = context.get_autofocus_element();
@@ -483,9 +493,43 @@ public:
         return recompui::ContextId::null();
     }
 
+    // Marks every shown context as needing a new layout, e.g. when the window is resized.
+    void mark_layouts_dirty() {
+        for (auto& context_details : shown_contexts) {
+            context_details.context.mark_layout_dirty();
+        }
+    }
+
+    // Collects the shown contexts with changes for the upcoming layout pass. Hidden contexts aren't laid out, so they
+    // keep their changes until they're shown.
+    void collect_layout_changes() {
+        relayout_contexts.clear();
+        for (auto& context_details : shown_contexts) {
+            if (context_details.context.take_layout_changes()) {
+                relayout_contexts.emplace_back(context_details.context);
+            }
+        }
+    }
+
+    // Marks the cached element geometry of the contexts collected above as stale once they've been laid out. Contexts
+    // with no changes keep their cached geometry and navigation spatial index.
+    void invalidate_layouts() {
+        for (recompui::ContextId context : relayout_contexts) {
+            context.invalidate_layout();
+        }
+    }
+
     void update_contexts() {
+        recompui::advance_animation_clock();
         for (auto& context_details : shown_contexts) {
+            // Contexts with nothing running or queued have no changes to draw, so skip taking their lock until they do.
+            if (!context_details.context.is_animating() && !context_details.context.has_frame_work()) {
+                continue;
+            }
+
             context_details.context.open();
+            context_details.context.process_animations();
+            context_details.context.process_data_bindings();
             context_details.context.process_updates();
             context_details.context.close();
         }
@@ -527,6 +571,78 @@ bool recompui::try_deque_event(SDL_Event& out) {
     return ui_event_queue.try_dequeue(out);
 }
 
+static struct {
+    std::atomic<uint64_t> motion_events_received = 0;
+    std::atomic<uint64_t> motion_events_dispatched = 0;
+    std::atomic<uint64_t> wheel_events_received = 0;
+    std::atomic<uint64_t> wheel_events_dispatched = 0;
+} input_coalescing_stats;
+
+recompui::InputCoalescingStats recompui::get_input_coalescing_stats() {
+    recompui::InputCoalescingStats ret{};
+    ret.motion_events_received = input_coalescing_stats.motion_events_received.load();
+    ret.motion_events_dispatched = input_coalescing_stats.motion_events_dispatched.load();
+    ret.wheel_events_received = input_coalescing_stats.wheel_events_received.load();
+    ret.wheel_events_dispatched = input_coalescing_stats.wheel_events_dispatched.load();
+    return ret;
+}
+
+// Drains the UI event queue into a list of events for this frame. Runs of mouse motion are merged into one motion event
+// at the final position with the combined relative motion, and consecutive wheel events are merged into one scroll.
+// Any other event ends a run, so button presses still happen at the position the cursor was at when they occurred.
+// This keeps high polling rate mice from causing dozens of hover hit tests per frame.
+static void dequeue_coalesced_events(std::vector<SDL_Event>& out) {
+    auto& stats = input_coalescing_stats;
+    SDL_Event cur_event{};
+
+    out.clear();
+    while (recompui::try_deque_event(cur_event)) {
+        SDL_Event* prev_event = out.empty() ? nullptr : &out.back();
+        switch (cur_event.type) {
+        case SDL_EventType::SDL_MOUSEMOTION:
+            stats.motion_events_received++;
+            if (prev_event != nullptr && prev_event->type == SDL_EventType::SDL_MOUSEMOTION &&
+                prev_event->motion.which == cur_event.motion.which && prev_event->motion.windowID == cur_event.motion.windowID)
+            {
+                prev_event->motion.timestamp = cur_event.motion.timestamp;
+                prev_event->motion.state = cur_event.motion.state;
+                prev_event->motion.x = cur_event.motion.x;
+                prev_event->motion.y = cur_event.motion.y;
+                prev_event->motion.xrel += cur_event.motion.xrel;
+                prev_event->motion.yrel += cur_event.motion.yrel;
+                continue;
+            }
+            stats.motion_events_dispatched++;
+            break;
+        case SDL_EventType::SDL_MOUSEWHEEL:
+            stats.wheel_events_received++;
+            if (prev_event != nullptr && prev_event->type == SDL_EventType::SDL_MOUSEWHEEL &&
+                prev_event->wheel.which == cur_event.wheel.which && prev_event->wheel.windowID == cur_event.wheel.windowID &&
+                prev_event->wheel.direction == cur_event.wheel.direction)
+            {
+                prev_event->wheel.timestamp = cur_event.wheel.timestamp;
+                prev_event->wheel.x += cur_event.wheel.x;
+                prev_event->wheel.y += cur_event.wheel.y;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+                prev_event->wheel.preciseX += cur_event.wheel.preciseX;
+                prev_event->wheel.preciseY += cur_event.wheel.preciseY;
+#endif
+#if SDL_VERSION_ATLEAST(2, 26, 0)
+                prev_event->wheel.mouseX = cur_event.wheel.mouseX;
+                prev_event->wheel.mouseY = cur_event.wheel.mouseY;
+#endif
+                continue;
+            }
+            stats.wheel_events_dispatched++;
+            break;
+        default:
+            break;
+        }
+
+        out.emplace_back(cur_event);
+    }
+}
+
 recompui::MenuAction recompui::menu_action_mapping::menu_action_from_rml_key(const Rml::Input::KeyIdentifier& key) {
     auto it = recompui::menu_action_mapping::rml_key_to_action.find(key);
     if (it != recompui::menu_action_mapping::rml_key_to_action.end()) {
@@ -662,7 +778,8 @@ void draw_hook(plume::RenderCommandList* command_list, plume::RenderFramebuffer*
 
     std::lock_guard lock{ ui_state_mutex };
 
-    SDL_Event cur_event{};
+    static std::vector<SDL_Event> frame_events{};
+    dequeue_coalesced_events(frame_events);
 
     bool mouse_moved = false;
     bool mouse_clicked = false;
@@ -672,184 +789,198 @@ void draw_hook(plume::RenderCommandList* command_list, plume::RenderFramebuffer*
 
     bool config_was_open = recompui::is_context_shown(recompui::config::get_config_context_id());
 
-    using clock = std::chrono::system_clock;
-
-    // TODO move these into a more appropriate place.
-    constexpr clock::duration start_repeat_delay = std::chrono::milliseconds{500};
-    constexpr clock::duration repeat_rate = std::chrono::milliseconds{50};
-    static clock::time_point next_repeat_time = {};
-    static int latest_controller_key_pressed = SDLK_UNKNOWN;
+    static recompui::KeyRepeatScheduler key_repeat{};
 
     bool all_input_is_disabled = recompinput::all_input_disabled();
 
-    while (recompui::try_deque_event(cur_event)) {
-        bool context_capturing_input = recompui::is_context_capturing_input();
-        bool context_capturing_mouse = recompui::is_context_capturing_mouse();
-
-        // Handle up button events even when input is disabled to avoid missing them during binding.
-        if (cur_event.type == SDL_EventType::SDL_CONTROLLERBUTTONUP) {
-            int sdl_key = cont_button_to_key(cur_event.cbutton);
-            if (sdl_key == latest_controller_key_pressed) {
-                latest_controller_key_pressed = SDLK_UNKNOWN;
+    // Held inputs won't be seen while input is disabled, so their releases could be missed.
+    if (all_input_is_disabled) {
+        key_repeat.release_all();
+    }
+
+    // Keep contexts open between the RmlUi events generated by the queued input instead of reopening them for every event.
+    // The batch ends with this block, which closes whichever context it was holding.
+    {
+        recompui::EventDispatchBatch dispatch_batch{};
+
+        for (SDL_Event& cur_event : frame_events) {
+            bool context_capturing_input = recompui::is_context_capturing_input();
+            bool context_capturing_mouse = recompui::is_context_capturing_mouse();
+
+            // Handle up button events even when input is disabled to avoid missing them during binding.
+            if (cur_event.type == SDL_EventType::SDL_CONTROLLERBUTTONUP) {
+                int sdl_key = cont_button_to_key(cur_event.cbutton);
+                if (sdl_key) {
+                    key_repeat.release(cur_event.cbutton.which, sdl_key);
+                }
+            }
+            // A removed controller won't send the releases for whatever it was holding.
+            else if (cur_event.type == SDL_EventType::SDL_CONTROLLERDEVICEREMOVED) {
+                key_repeat.release_device(cur_event.cdevice.which);
             }
-        }
 
-        if (!all_input_is_disabled) {
-            bool is_mouse_input = false;
-            // Implement some additional behavior for specific events on top of what RmlUi normally does with them.
-            switch (cur_event.type) {
-            case SDL_EventType::SDL_MOUSEMOTION: {
-                int *last_mouse_pos = ui_state->last_active_mouse_position;
-
-                if (!ui_state->mouse_is_active) {
-                    float xD = cur_event.motion.x - last_mouse_pos[0];
-                    float yD = cur_event.motion.y - last_mouse_pos[1];
-                    if (sqrt(xD * xD + yD * yD) < 100) {
+            if (!all_input_is_disabled) {
+                bool is_mouse_input = false;
+                // Implement some additional behavior for specific events on top of what RmlUi normally does with them.
+                switch (cur_event.type) {
+                case SDL_EventType::SDL_MOUSEMOTION: {
+                    int *last_mouse_pos = ui_state->last_active_mouse_position;
+
+                    if (!ui_state->mouse_is_active) {
+                        float xD = cur_event.motion.x - last_mouse_pos[0];
+                        float yD = cur_event.motion.y - last_mouse_pos[1];
+                        if (sqrt(xD * xD + yD * yD) < 100) {
+                            break;
+                        }
+                    }
+                    last_mouse_pos[0] = cur_event.motion.x;
+                    last_mouse_pos[1] = cur_event.motion.y;
+
+                    // if controller is the primary input, don't use mouse movement to allow cursor to reactivate
+                    if (recompui::get_cont_active()) {
                         break;
                     }
                 }
-                last_mouse_pos[0] = cur_event.motion.x;
-                last_mouse_pos[1] = cur_event.motion.y;
-
-                // if controller is the primary input, don't use mouse movement to allow cursor to reactivate
-                if (recompui::get_cont_active()) {
+                // fallthrough
+                case SDL_EventType::SDL_MOUSEBUTTONDOWN:
+                    mouse_moved = true;
+                    mouse_clicked = true;
+                    is_mouse_input = true;
                     break;
-                }
-            }
-            // fallthrough
-            case SDL_EventType::SDL_MOUSEBUTTONDOWN:
-                mouse_moved = true;
-                mouse_clicked = true;
-                is_mouse_input = true;
-                break;
                 
-            case SDL_EventType::SDL_MOUSEBUTTONUP:
-            case SDL_EventType::SDL_MOUSEWHEEL:
-                is_mouse_input = true;
-                break;
+                case SDL_EventType::SDL_MOUSEBUTTONUP:
+                case SDL_EventType::SDL_MOUSEWHEEL:
+                    is_mouse_input = true;
+                    break;
                 
-            case SDL_EventType::SDL_CONTROLLERBUTTONDOWN: {
-                int sdl_key = cont_button_to_key(cur_event.cbutton);
-                if (context_capturing_input && sdl_key) {
-                    ui_state->context->ProcessKeyDown(convert_sdl_to_rml(sdl_key), 0);
-                    latest_controller_key_pressed = sdl_key;
-                    next_repeat_time = clock::now() + start_repeat_delay;
-                }
-                non_mouse_interacted = true;
-                cont_interacted = true;
-                break;
-            }
-            case SDL_EventType::SDL_KEYDOWN:
-                // Exclude the ESC key from triggering keyboard mode.
-                if (cur_event.key.keysym.scancode != SDL_Scancode::SDL_SCANCODE_ESCAPE) {
+                case SDL_EventType::SDL_CONTROLLERBUTTONDOWN: {
+                    int sdl_key = cont_button_to_key(cur_event.cbutton);
+                    if (context_capturing_input && sdl_key) {
+                        ui_state->context->ProcessKeyDown(convert_sdl_to_rml(sdl_key), 0);
+                        key_repeat.press(cur_event.cbutton.which, sdl_key);
+                    }
                     non_mouse_interacted = true;
-                    kb_interacted = true;
+                    cont_interacted = true;
+                    break;
+                }
+                case SDL_EventType::SDL_KEYDOWN:
+                    // Exclude the ESC key from triggering keyboard mode.
+                    if (cur_event.key.keysym.scancode != SDL_Scancode::SDL_SCANCODE_ESCAPE) {
+                        non_mouse_interacted = true;
+                        kb_interacted = true;
 
-                    if (cur_event.key.keysym.scancode == SDL_Scancode::SDL_SCANCODE_F8) {
-                        if (recompui::config::general::get_debug_mode_enabled()) {
-                            Rml::Debugger::SetVisible(!Rml::Debugger::IsVisible());
+                        if (cur_event.key.keysym.scancode == SDL_Scancode::SDL_SCANCODE_F8) {
+                            if (recompui::config::general::get_debug_mode_enabled()) {
+                                Rml::Debugger::SetVisible(!Rml::Debugger::IsVisible());
+                            }
+                        }
+                        else if (cur_event.key.keysym.scancode == SDL_Scancode::SDL_SCANCODE_F9) {
+                            if (recompui::config::general::get_debug_mode_enabled()) {
+                                // Showing or hiding the view opens other contexts, so don't keep one held across it.
+                                recompui::release_event_dispatch_context();
+                                recompui::toggle_api_profiler_view();
+                            }
                         }
                     }
-                }
 
-                break;
-            case SDL_EventType::SDL_USEREVENT:
-                if (cur_event.user.code == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTY) {
-                    ui_state->await_stick_return_y = true;
-                } else if (cur_event.user.code == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTX) {
-                    ui_state->await_stick_return_x = true;
-                }
-                break;
-            case SDL_EventType::SDL_CONTROLLERAXISMOTION:
-                SDL_ControllerAxisEvent* axis_event = &cur_event.caxis;
-                if (axis_event->axis != SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTY && axis_event->axis != SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTX) {
                     break;
-                }
+                case SDL_EventType::SDL_USEREVENT:
+                    if (cur_event.user.code == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTY) {
+                        ui_state->await_stick_return_y = true;
+                    } else if (cur_event.user.code == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTX) {
+                        ui_state->await_stick_return_x = true;
+                    }
+                    break;
+                case SDL_EventType::SDL_CONTROLLERAXISMOTION:
+                    SDL_ControllerAxisEvent* axis_event = &cur_event.caxis;
+                    if (axis_event->axis != SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTY && axis_event->axis != SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTX) {
+                        break;
+                    }
 
-                float axis_value = axis_event->value * (1 / 32768.0f);
-                bool* await_stick_return = axis_event->axis == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTY
-                        ? &ui_state->await_stick_return_y
-                        : &ui_state->await_stick_return_x;
-                if (fabsf(axis_value) > 0.5f) {
-                    if (!*await_stick_return) {
-                        *await_stick_return = true;
-                        non_mouse_interacted = true;
-                        int sdl_key = cont_axis_to_key(cur_event.caxis, axis_value);
-                        if (context_capturing_input && sdl_key) {
-                            ui_state->context->ProcessKeyDown(convert_sdl_to_rml(sdl_key), 0);
-                            latest_controller_key_pressed = sdl_key;
-                            next_repeat_time = clock::now() + start_repeat_delay;
+                    float axis_value = axis_event->value * (1 / 32768.0f);
+                    bool* await_stick_return = axis_event->axis == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_LEFTY
+                            ? &ui_state->await_stick_return_y
+                            : &ui_state->await_stick_return_x;
+                    if (fabsf(axis_value) > 0.5f) {
+                        if (!*await_stick_return) {
+                            *await_stick_return = true;
+                            non_mouse_interacted = true;
+                            int sdl_key = cont_axis_to_key(cur_event.caxis, axis_value);
+                            if (context_capturing_input && sdl_key) {
+                                ui_state->context->ProcessKeyDown(convert_sdl_to_rml(sdl_key), 0);
+                                key_repeat.press(axis_event->which, sdl_key);
+                            }
                         }
+                        non_mouse_interacted = true;
+                        cont_interacted = true;
                     }
-                    non_mouse_interacted = true;
-                    cont_interacted = true;
-                }
-                else if (*await_stick_return && fabsf(axis_value) < 0.15f) {
-                    *await_stick_return = false;
-                    // Stop pressing the current key if the axis that was released was the one triggering key presses.
-                    int sdl_key = cont_axis_to_key(cur_event.caxis, axis_value);
-                    if (sdl_key == latest_controller_key_pressed) {
-                        latest_controller_key_pressed = SDLK_UNKNOWN;
+                    else if (*await_stick_return && fabsf(axis_value) < 0.15f) {
+                        *await_stick_return = false;
+                        // Stop repeating both directions of the axis, as the value no longer says which one was held.
+                        key_repeat.release(axis_event->which, cont_axis_to_key(cur_event.caxis, -1.0f));
+                        key_repeat.release(axis_event->which, cont_axis_to_key(cur_event.caxis, 1.0f));
                     }
+                    break;
                 }
-                break;
-            }
 
-            // Send the event to RmlUi if this type of event is being captured.
-            if (is_mouse_input) {
-                if (context_capturing_mouse) {
-                    RmlSDL::InputEventHandler(ui_state->context, cur_event);
+                // Send the event to RmlUi if this type of event is being captured.
+                if (is_mouse_input) {
+                    if (context_capturing_mouse) {
+                        RmlSDL::InputEventHandler(ui_state->context, cur_event);
+
+                        // Scrolling moves elements without a layout pass, so cached element geometry needs to be refreshed.
+                        if (cur_event.type == SDL_EventType::SDL_MOUSEWHEEL) {
+                            ui_state->top_mouse_context().invalidate_layout();
+                        }
+                    }
                 }
-            }
-            else {
-                if (context_capturing_input) {
-                    RmlSDL::InputEventHandler(ui_state->context, cur_event);
+                else {
+                    if (context_capturing_input) {
+                        RmlSDL::InputEventHandler(ui_state->context, cur_event);
+                    }
                 }
             }
-        }
 
-        // If the config menu isn't open and the game has been started and either the escape key or select button are pressed, open the config menu.
-        if (!config_was_open && ultramodern::is_game_started()) {
-            bool open_config = false;
+            // If the config menu isn't open and the game has been started and either the escape key or select button are pressed, open the config menu.
+            if (!config_was_open && ultramodern::is_game_started()) {
+                bool open_config = false;
 
-            switch (cur_event.type) {
-            case SDL_EventType::SDL_KEYDOWN:
-                if (cur_event.key.keysym.scancode == SDL_Scancode::SDL_SCANCODE_ESCAPE) {
-                    open_config = true;
-                }
-                break;
-            case SDL_EventType::SDL_CONTROLLERBUTTONDOWN: {
-                SDL_ControllerButtonEvent* button_event = &cur_event.cbutton;
-                SDL_JoystickID joystick_id = button_event->which;
-                int profile_index;
-                if (recompinput::players::is_single_player_mode()) {
-                    profile_index = recompinput::profiles::get_sp_controller_profile_index();
+                switch (cur_event.type) {
+                case SDL_EventType::SDL_KEYDOWN:
+                    if (cur_event.key.keysym.scancode == SDL_Scancode::SDL_SCANCODE_ESCAPE) {
+                        open_config = true;
+                    }
+                    break;
+                case SDL_EventType::SDL_CONTROLLERBUTTONDOWN: {
+                    SDL_ControllerButtonEvent* button_event = &cur_event.cbutton;
+                    SDL_JoystickID joystick_id = button_event->which;
+                    int profile_index;
+                    if (recompinput::players::is_single_player_mode()) {
+                        profile_index = recompinput::profiles::get_sp_controller_profile_index();
+                    }
+                    else {
+                        auto controller = recompinput::get_controller_from_joystick_id(joystick_id);
+                        profile_index = recompinput::profiles::get_controller_profile_index_from_sdl_controller(controller);
+                    }
+
+                    if (check_menu_button_pressed(profile_index, recompinput::GameInput::TOGGLE_MENU, cur_event.cbutton.button)) {
+                        open_config = true;
+                    }
+                    break;
                 }
-                else {
-                    auto controller = recompinput::get_controller_from_joystick_id(joystick_id);
-                    profile_index = recompinput::profiles::get_controller_profile_index_from_sdl_controller(controller);
                 }
 
-                if (check_menu_button_pressed(profile_index, recompinput::GameInput::TOGGLE_MENU, cur_event.cbutton.button)) {
-                    open_config = true;
+                if (open_config) {
+                    recompui::release_event_dispatch_context();
+                    recompui::config::open();
                 }
-                break;
-            }
             }
+        } // end dequeue event loop
 
-            if (open_config) {
-                recompui::config::open();
-            }
-        }
-    } // end dequeue event loop
-
-    // Handle controller key repeats.
-    if (latest_controller_key_pressed != SDLK_UNKNOWN) {
-        clock::time_point now = clock::now();
-        if (now >= next_repeat_time) {
-            ui_state->context->ProcessKeyDown(convert_sdl_to_rml(latest_controller_key_pressed), 0);
-            next_repeat_time += repeat_rate;
-        }
+        // Handle controller key repeats.
+        key_repeat.poll([](int sdl_key) {
+            ui_state->context->ProcessKeyDown(convert_sdl_to_rml(sdl_key), 0);
+        });
     }
 
     if (cont_interacted || kb_interacted || mouse_clicked) {
@@ -864,6 +995,7 @@ void draw_hook(plume::RenderCommandList* command_list, plume::RenderFramebuffer*
             recompui::update_launcher_menu();
         }
 
+        recompui::update_api_profiler_view();
         ui_state->update_contexts();
 
         int width = swap_chain_framebuffer->getWidth();
@@ -879,11 +1011,14 @@ void draw_hook(plume::RenderCommandList* command_list, plume::RenderFramebuffer*
 
         if (prev_width != width || prev_height != height) {
             ui_state->context->SetDimensions({ width, height });
+            ui_state->mark_layouts_dirty();
         }
         prev_width = width;
         prev_height = height;
 
+        ui_state->collect_layout_changes();
         ui_state->context->Update();
+        ui_state->invalidate_layouts();
         ui_state->context->Render();
         ui_state->render_interface.end(command_list, swap_chain_framebuffer);
     }
@@ -1010,6 +1145,22 @@ void recompui::queue_image_from_bytes_rgba32(const std::string &src, const std::
     ui_state->render_interface.queue_image_from_bytes_rgba32(src, bytes, width, height);
 }
 
+void recompui::create_dynamic_image(uint32_t texture, uint32_t width, uint32_t height) {
+    ui_state->render_interface.create_dynamic_image(texture, width, height);
+}
+
+bool recompui::update_dynamic_image(uint32_t texture, const char *bytes, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    return ui_state->render_interface.update_dynamic_image(texture, bytes, x, y, width, height);
+}
+
+bool recompui::get_dynamic_image_size(uint32_t texture, uint32_t &width, uint32_t &height) {
+    return ui_state->render_interface.get_dynamic_image_size(texture, width, height);
+}
+
+void recompui::release_dynamic_image(uint32_t texture) {
+    ui_state->render_interface.release_dynamic_image(texture);
+}
+
 void recompui::release_image(const std::string &src) {
     Rml::ReleaseTexture(src);
 }
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+#include "recompui.h"
+
+#include "api/ui_api_profiler.h"
+#include "elements/ui_element.h"
+#include "elements/ui_document.h"
+#include "elements/ui_label.h"
+#include "util/file.h"
+
+// Number of entries listed in the view, and how often the view is refreshed.
+constexpr size_t profiler_view_max_entries = 24;
+constexpr std::chrono::milliseconds profiler_view_refresh_interval{ 500 };
+
+struct {
+    recompui::ContextId ui_context = recompui::ContextId::null();
+    recompui::Label* profile_label = nullptr;
+    std::chrono::steady_clock::time_point last_refresh{};
+    std::mutex mutex;
+} profiler_view_state;
+
+static void init_profiler_view_context() {
+    using namespace recompui;
+
+    ContextId context = create_context();
+    context.open();
+
+    // The view is drawn over the game without taking input away from it.
+    context.set_captures_input(false);
+    context.set_captures_mouse(false);
+
+    Element* window = context.create_element<Element>(context.get_root_element());
+    window->set_position(Position::Absolute);
+    window->set_top(16.0f);
+    window->set_left(16.0f);
+    window->set_padding(12.0f);
+    window->set_border_radius(theme::border::radius_sm);
+    window->set_background_color(theme::color::BGOverlay);
+    window->set_pointer_events(PointerEvents::None);
+
+    profiler_view_state.profile_label = context.create_element<Label>(window, "", LabelStyle::Annotation);
+    profiler_view_state.profile_label->set_white_space(WhiteSpace::Pre);
+    profiler_view_state.ui_context = context;
+
+    context.close();
+}
+
+static std::string format_profile() {
+    std::vector<recompui::ApiProfileEntry> entries = recompui::get_api_profile();
+    std::string ret = "UI API profile (F9 to close and save)\nexport  context  calls  host ms  rdram bytes";
+
+    for (size_t i = 0; i < entries.size() && i < profiler_view_max_entries; i++) {
+        const recompui::ApiProfileEntry& entry = entries[i];
+        char line[256];
+        snprintf(line, sizeof(line), "\n%s  %s  %llu  %.3f  %llu",
+            entry.export_name.c_str(),
+            entry.context == recompui::ContextId::null() ? "-" : std::to_string(entry.context.slot_id).c_str(),
+            static_cast<unsigned long long>(entry.calls),
+            entry.host_time_ns / 1e6,
+            static_cast<unsigned long long>(entry.rdram_bytes));
+        ret += line;
+    }
+
+    return ret;
+}
+
+static void save_profile() {
+    std::filesystem::path profile_path = recompui::file::get_app_folder_path() / "ui_api_profile.json";
+    std::ofstream profile_file{ profile_path };
+    if (profile_file.good()) {
+        profile_file << recompui::get_api_profile_json();
+    }
+}
+
+void recompui::toggle_api_profiler_view() {
+    std::lock_guard lock{ profiler_view_state.mutex };
+    if (profiler_view_state.ui_context == ContextId::null()) {
+        init_profiler_view_context();
+    }
+
+    if (is_context_shown(profiler_view_state.ui_context)) {
+        set_api_profiling_enabled(false);
+        save_profile();
+        hide_context(profiler_view_state.ui_context);
+    }
+    else {
+        reset_api_profile();
+        set_api_profiling_enabled(true);
+        profiler_view_state.last_refresh = {};
+        show_context(profiler_view_state.ui_context, "");
+    }
+}
+
+void recompui::update_api_profiler_view() {
+    std::lock_guard lock{ profiler_view_state.mutex };
+    if (profiler_view_state.ui_context == ContextId::null() || !is_context_shown(profiler_view_state.ui_context)) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - profiler_view_state.last_refresh < profiler_view_refresh_interval) {
+        return;
+    }
+    profiler_view_state.last_refresh = now;
+
+    profiler_view_state.ui_context.open();
+    profiler_view_state.profile_label->set_text(format_profile());
+    profiler_view_state.ui_context.close();
+}
@@ -204,38 +204,16 @@ void ModEntryButton::process_event(const Event& e) {
 
 // ModEntrySpacer
 
-void ModEntrySpacer::check_height_distance() {
-    constexpr float tolerance = 0.01f;
-    if (abs(target_height - height) < tolerance) {
-        height = target_height;
-        set_height(height, Unit::Dp);
-    }
-    else {
-        queue_update();
-    }
-}
-
-void ModEntrySpacer::process_event(const Event &e) {
-    switch (e.type) {
-    case EventType::Update: {
-        std::chrono::high_resolution_clock::duration now = ultramodern::time_since_start();
-        float delta_time = std::max(std::chrono::duration<float>(now - last_time).count(), 0.0f);
-        constexpr float dp_speed = 1000.0f;
-        last_time = now;
-
-        if (target_height < height) {
-            height += std::max(-dp_speed * delta_time, target_height - height);
-        }
-        else {
-            height += std::min(dp_speed * delta_time, target_height - height);
-        }
+constexpr float spacer_dp_per_ms = 1.0f;
 
-        set_height(height, Unit::Dp);
-        check_height_distance();
-        break;
+float ModEntrySpacer::get_current_height() {
+    float elapsed_ms = std::max(std::chrono::duration<float, std::milli>(get_animation_clock() - animation_start).count(), 0.0f);
+    float max_change = elapsed_ms * spacer_dp_per_ms;
+    if (target_height < height) {
+        return std::max(height - max_change, target_height);
     }
-    default:
-        break;
+    else {
+        return std::min(height + max_change, target_height);
     }
 }
 
@@ -245,16 +223,20 @@ ModEntrySpacer::ModEntrySpacer(ResourceId rid, Element *parent) : Element(rid, p
 }
 
 void ModEntrySpacer::set_target_height(float target_height, bool animate_to_target) {
+    constexpr float tolerance = 0.01f;
+    height = animate_to_target ? get_current_height() : target_height;
     this->target_height = target_height;
+    animation_start = get_animation_clock();
 
-    if (animate_to_target) {
-        last_time = ultramodern::time_since_start();
-        check_height_distance();
-    }
-    else {
+    if (abs(target_height - height) < tolerance) {
         height = target_height;
+        stop_animations();
         set_height(target_height, Unit::Dp);
     }
+    else {
+        // Moves at a constant speed, so the duration depends on the distance.
+        animate(AnimationTrack::tween(AnimatedProperty::Height, height, target_height, abs(target_height - height) / spacer_dp_per_ms));
+    }
 }
 
 void ModEntrySpacer::set_active(bool active) {
@@ -607,12 +589,14 @@ void ModMenu::create_mod_list() {
         ModEntrySpacer *spacer = context.create_element<ModEntrySpacer>(list_scroll_container);
         mod_entry_spacers.emplace_back(spacer);
 
-        ModEntryButton *mod_entry = context.create_element<ModEntryButton>(list_scroll_container, mod_index);
+        // Build the entry's subtree outside of the document and attach it once it's fully set up.
+        ModEntryButton *mod_entry = context.create_detached_element<ModEntryButton>(mod_index);
         mod_entry->set_mod_selected_callback([this](uint32_t mod_index){ mod_selected(mod_index); });
         mod_entry->set_mod_drag_callback([this](uint32_t mod_index, recompui::EventDrag drag){ mod_dragged(mod_index, drag); });
         mod_entry->set_mod_details(mod_details[mod_index]);
         mod_entry->set_mod_thumbnail(thumbnail_name);
         mod_entry->set_mod_enabled(is_mod_enabled_or_auto(mod_details[mod_index].mod_id));
+        context.attach_element(mod_entry, list_scroll_container);
         mod_entry_buttons.emplace_back(mod_entry);
     }
 
@@ -56,14 +56,14 @@ private:
 
 class ModEntrySpacer : public Element {
 private:
+    // Height at the start of the current height animation.
     float height = 0.0f;
     float target_height = 0.0f;
     bool active = false;
-    std::chrono::high_resolution_clock::duration last_time;
+    std::chrono::high_resolution_clock::duration animation_start{};
 
-    void check_height_distance();
+    float get_current_height();
 protected:
-    virtual void process_event(const Event &e) override;
     std::string_view get_type_name() override { return "ModEntrySpacer"; }
 public:
     ModEntrySpacer(ResourceId rid, Element *parent);
@@ -1,6 +1,10 @@
+#include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <fstream>
 
 #include "slot_map.h"
@@ -12,6 +16,8 @@
 #include "ui_context.h"
 #include "elements/ui_element.h"
 #include "elements/ui_document.h"
+#include "elements/ui_animation.h"
+#include "elements/ui_data_binding.h"
 #include "data/base_rcss.h"
 #include "util/file.h"
 
@@ -33,15 +39,64 @@ struct std::hash<recompui::ResourceId> {
 using resource_slotmap = dod::slot_map32<std::unique_ptr<recompui::Style>>;
 
 namespace recompui {
+    // Bookkeeping for a resource created while resource tracking is enabled.
+    struct ResourceRecord {
+        const char* origin;
+        bool is_element;
+    };
+
+    struct ActiveAnimation {
+        ResourceId element;
+        Style* target;
+        AnimationTrack track;
+        std::chrono::high_resolution_clock::duration start_time;
+        // Last value that was written, used to skip writing properties that haven't changed.
+        std::optional<Rml::Property> last_value;
+    };
+
+    struct ActiveDataBinding {
+        ResourceId element;
+        DataBinding binding;
+    };
+
     struct Context {
         std::mutex context_lock;
         resource_slotmap resources;
         Rml::ElementDocument* document;
+        // Bumped by any change that can affect the navigation tree, which tells the document to rebuild its cached tree.
+        std::atomic<uint32_t> navigation_generation = 1;
+        // Bumped after layout passes that had changes to lay out and by anything else that moves elements on screen,
+        // like scrolling. These are bumped from the UI thread while the context may be open on another thread, so
+        // they're atomic.
+        std::atomic<uint32_t> layout_generation = 1;
+        // Set by changes that RmlUi's next layout pass can move elements for, see take_layout_changes.
+        std::atomic<bool> layout_dirty = true;
+        // Declared after the generations, as the root element's destructor can still bump them.
         Document root_element;
         Element* autofocus_element = nullptr;
         std::vector<Element*> loose_elements;
-        std::unordered_set<ResourceId> to_update;
-        std::vector<std::tuple<ResourceId, std::string>> to_set_text;     
+        // Maps the Rml elements backing this context's elements to their resource IDs. This is used to find the
+        // element for an Rml element (e.g. the focused element) without needing to give every element a string id.
+        std::unordered_map<Rml::Element*, ResourceId> elements_by_base;
+        // Elements queued for an update, in the order they were queued. Each element's update_queued bit
+        // guarantees it only appears in this list once.
+        std::vector<ResourceId> to_update;
+        // Scratch list that to_update is swapped into while updates are being processed, which keeps the
+        // allocations of both lists alive across frames.
+        std::vector<ResourceId> processing_updates;
+        std::vector<std::pair<uint32_t, ResourceId>> update_order;
+        // Elements with pending text, in the order their text was first set. The text itself is stored
+        // on the element so that repeated assignments within a frame replace each other.
+        std::vector<ResourceId> to_set_text;
+        std::vector<ResourceId> processing_text;
+        // Counters for the frame that's currently being queued, and the counters for the last processed frame.
+        UpdateStats frame_stats{};
+        UpdateStats update_stats{};
+        // Records for resources created while tracking is enabled, used to find leaks.
+        bool track_resources = false;
+        std::unordered_map<ResourceId, ResourceRecord> resource_records;
+        std::vector<ActiveAnimation> animations;
+        std::vector<ActiveDataBinding> data_bindings;
         bool captures_input = true;
         bool captures_mouse = true;
         Context(ResourceId rid, Rml::ElementDocument* document) : document(document), root_element(rid, document) {}
@@ -60,6 +115,10 @@ static struct {
 
 thread_local recompui::Context* opened_context = nullptr;
 thread_local recompui::ContextId opened_context_id = recompui::ContextId::null();
+thread_local const char* resource_origin = nullptr;
+// Nesting depth of EventDispatchBatch scopes on this thread, and the context that's being held open by them.
+thread_local int dispatch_batch_depth = 0;
+thread_local recompui::ContextId dispatch_batch_context = recompui::ContextId::null();
 
 enum class ContextErrorType {
     OpenWithoutClose,
@@ -74,6 +133,9 @@ enum class ContextErrorType {
     UpdateElementInWrongContext,
     SetTextElementWithoutContext,
     SetTextElementInWrongContext,
+    AttachElementWithoutOpen,
+    AttachElementInWrongContext,
+    AttachElementNotDetached,
     GetResourceWithoutOpen,
     GetResourceFailed,
     DestroyResourceWithoutOpen,
@@ -132,6 +194,15 @@ void context_error(recompui::ContextId id, ContextErrorType type) {
         case ContextErrorType::SetTextElementInWrongContext:
             error_message = "Attempted to set the text of a UI element in a different UI context than the one that's open";
             break;
+        case ContextErrorType::AttachElementWithoutOpen:
+            error_message = "Attempted to attach a UI element with no open UI context";
+            break;
+        case ContextErrorType::AttachElementInWrongContext:
+            error_message = "Attempted to attach a UI element in a different UI context than the one that's open";
+            break;
+        case ContextErrorType::AttachElementNotDetached:
+            error_message = "Attempted to attach a UI element that isn't detached";
+            break;
         case ContextErrorType::GetResourceWithoutOpen:
             error_message = "Attempted to get a UI resource with no open UI context";
             break;
@@ -171,6 +242,30 @@ void context_error(recompui::ContextId id, ContextErrorType type) {
     ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
 }
 
+// Gets the element for a resource in the given context, treating the root element's resource ID as the root document.
+// Returns null if the resource doesn't exist or hasn't finished being constructed yet.
+static recompui::Element* get_context_element(recompui::Context* ctx, recompui::ResourceId resource) {
+    if (ctx->root_element.resource_id == resource) {
+        return &ctx->root_element;
+    }
+
+    std::unique_ptr<recompui::Style>* cur_resource = ctx->resources.get(resource_slotmap::key{ resource.slot_id });
+    if (cur_resource == nullptr) {
+        return nullptr;
+    }
+
+    return static_cast<recompui::Element*>(cur_resource->get());
+}
+
+// Number of ancestors between an element and the root of its tree. Used to process parents before their children.
+static uint32_t get_element_depth(const recompui::Element* element) {
+    uint32_t depth = 0;
+    for (const recompui::Element* cur = element->get_parent(); cur != nullptr; cur = cur->get_parent()) {
+        depth++;
+    }
+    return depth;
+}
+
 recompui::ContextId create_context_impl(Rml::ElementDocument* document) {
     static Rml::ElementDocument dummy_document{""};
     bool add_to_dict = true;
@@ -194,12 +289,14 @@ recompui::ContextId create_context_impl(Rml::ElementDocument* document) {
 
         // Set the root element's resource ID.
         context->root_element.resource_id = document_id;
+        context->root_element.owning_context = ret;
 
         // Update the entry for the root element's resource ID in the resources slotmap.
         *context->resources.get(document_key) = std::make_unique<recompui::Element>(document_id, document);
 
         if (add_to_dict) {
             context_state.documents_to_contexts.emplace(document, ret);
+            context->root_element.attach_event_routers();
         }
     }
 
@@ -260,6 +357,7 @@ recompui::ContextId recompui::create_context(const std::filesystem::path& path)
     Rml::ElementDocument* doc = recompui::load_document(path.string());
     opened_context->document = doc;
     opened_context->root_element.base = doc;
+    opened_context->root_element.attach_event_routers();
     new_context.close();
     
     {
@@ -315,11 +413,14 @@ void recompui::destroy_context(ContextId id) {
 
     id.open();
     id.clear_children();
+    opened_context->root_element.detach_event_routers();
     id.close();
 
-    // Delete the provided id.
+    // Delete the provided id. The root element removes the document from its RmlUi context when it's destroyed, so
+    // drop the document's entry as well in case a new document is allocated at the same address.
     {
         std::lock_guard lock{ context_state.all_contexts_lock };
+        std::erase_if(context_state.documents_to_contexts, [id](const auto& entry) { return entry.second == id; });
         context_state.all_contexts.erase(context_slotmap::key{ id.slot_id });
     }
 }
@@ -345,6 +446,7 @@ void recompui::destroy_all_contexts() {
         opened_context_id = ContextId{ key };
 
         opened_context_id.clear_children();
+        ctx->root_element.detach_event_routers();
 
         opened_context = nullptr;
         opened_context_id = ContextId::null();
@@ -354,7 +456,15 @@ void recompui::destroy_all_contexts() {
     context_state.documents_to_contexts.clear();
 }
 
+bool recompui::ContextId::exists() {
+    std::lock_guard lock{ context_state.all_contexts_lock };
+    return context_state.all_contexts.get(context_slotmap::key{ slot_id }) != nullptr;
+}
+
 void recompui::ContextId::open() {
+    // A context that's only open because an event dispatch batch is holding it can be closed to make way for this one.
+    release_event_dispatch_context();
+
     // Ensure no other context is opened by this thread already.
     if (opened_context_id != ContextId::null()) {
         context_error(*this, ContextErrorType::OpenWithoutClose);
@@ -402,6 +512,10 @@ void recompui::ContextId::close() {
         context_error(*this, ContextErrorType::CloseWrongContext);
     }
 
+    if (dispatch_batch_context == *this) {
+        dispatch_batch_context = ContextId::null();
+    }
+
     // Release ownership of the target context.
     opened_context->context_lock.unlock();
     opened_context = nullptr;
@@ -414,7 +528,44 @@ void recompui::ContextId::close() {
     }
 }
 
+bool recompui::ContextId::hold_for_event_dispatch() {
+    if (dispatch_batch_depth == 0 || opened_context_id != *this) {
+        return false;
+    }
+
+    dispatch_batch_context = *this;
+    return true;
+}
+
+bool recompui::ContextId::is_held_for_event_dispatch() {
+    return dispatch_batch_context == *this && opened_context_id == *this;
+}
+
+void recompui::release_event_dispatch_context() {
+    if (dispatch_batch_context != ContextId::null()) {
+        ContextId held_context = dispatch_batch_context;
+        dispatch_batch_context = ContextId::null();
+        if (opened_context_id == held_context) {
+            held_context.close();
+        }
+    }
+}
+
+recompui::EventDispatchBatch::EventDispatchBatch() {
+    dispatch_batch_depth++;
+}
+
+recompui::EventDispatchBatch::~EventDispatchBatch() {
+    dispatch_batch_depth--;
+    if (dispatch_batch_depth == 0) {
+        release_event_dispatch_context();
+    }
+}
+
 recompui::ContextId recompui::try_close_current_context() {
+    // The held context doesn't need to be restored by the caller, so close it and report that nothing was open.
+    release_event_dispatch_context();
+
     if (opened_context_id != ContextId::null()) {
         ContextId prev_context = opened_context_id;
         opened_context_id.close();
@@ -434,61 +585,496 @@ void recompui::ContextId::process_updates() {
         context_error(*this, ContextErrorType::InternalError);
     }
 
-    // Move the current update set into a local variable. This clears the update set
+    Context* ctx = opened_context;
+
+    // Swap the current update list into the scratch list. This clears the update list
     // and allows it to be used to queue updates from any element callbacks.
-    std::unordered_set<ResourceId> to_update = std::move(opened_context->to_update);
+    std::swap(ctx->to_update, ctx->processing_updates);
+    ctx->to_update.clear();
+    ctx->frame_stats.queued_updates = static_cast<uint32_t>(ctx->processing_updates.size());
+
+    // Sort the queued elements so that parents are always updated before their children. The sort is stable,
+    // so elements at the same depth are updated in the order they were queued.
+    ctx->update_order.clear();
+    for (ResourceId cur_resource_id : ctx->processing_updates) {
+        // Ignore any resources that aren't elements.
+        if (ctx->root_element.resource_id != cur_resource_id &&
+            resource_slotmap::key{ cur_resource_id.slot_id }.get_tag() != static_cast<uint8_t>(SlotTag::Element))
+        {
+            // Assert to catch errors of queueing other resource types for update.
+            // This isn't an actual error, so there's no issue with continuing in release builds.
+            assert(false);
+            continue;
+        }
+
+        Element* cur_element = get_context_element(ctx, cur_resource_id);
+        if (cur_element == nullptr) {
+            ctx->frame_stats.dropped_updates++;
+            continue;
+        }
+
+        ctx->update_order.emplace_back(get_element_depth(cur_element), cur_resource_id);
+    }
+    ctx->processing_updates.clear();
 
+    std::stable_sort(ctx->update_order.begin(), ctx->update_order.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    // Style phase: dispatch update events, which is where elements apply their style changes.
     Event update_event = Event::update_event();
 
-    for (auto cur_resource_id : to_update) {
-        resource_slotmap::key cur_key{ cur_resource_id.slot_id };
+    for (const auto& cur_update : ctx->update_order) {
+        ResourceId cur_resource_id = cur_update.second;
 
-        // Allow update events to the root document element.
-        if (opened_context->root_element.resource_id == cur_resource_id) {
-            static_cast<Element*>(&opened_context->root_element)->handle_event(update_event);
+        // Look the element up again, as it may have been deleted by an earlier update in this batch.
+        Element* cur_element = get_context_element(ctx, cur_resource_id);
+        if (cur_element == nullptr) {
+            ctx->frame_stats.dropped_updates++;
             continue;
         }
 
-        // Ignore any resources that aren't elements.
-        if (cur_key.get_tag() != static_cast<uint8_t>(SlotTag::Element)) {
-            // Assert to catch errors of queueing other resource types for update.
-            // This isn't an actual error, so there's no issue with continuing in release builds.
-            assert(false);
+        // Clear the dirty bit before dispatching so the element can queue itself for the next frame.
+        cur_element->update_queued = false;
+        cur_element->handle_event(update_event);
+        ctx->frame_stats.update_events++;
+    }
+
+    // Text phase: set the text of Rml elements that have pending text assignments.
+    std::swap(ctx->to_set_text, ctx->processing_text);
+    ctx->to_set_text.clear();
+
+    for (ResourceId resource : ctx->processing_text) {
+        assert(resource != ResourceId::null());
+
+        // Make sure the element exists before setting its text, as it may have been deleted.
+        Element* cur_element = get_context_element(ctx, resource);
+        if (cur_element == nullptr) {
             continue;
         }
 
-        // Get the resource being updaten from the context.
-        std::unique_ptr<Style>* cur_resource = opened_context->resources.get(cur_key);
+        cur_element->text_queued = false;
 
-        // Make sure the resource exists before dispatching the event. It may have been deleted
-        // after being queued for a update, so just continue to the next element if it doesn't exist.
-        if (cur_resource == nullptr) {
+        // Skip the update if the text was set back to what the element already contains.
+        if (cur_element->pending_text == cur_element->current_text) {
+            ctx->frame_stats.text_updates_skipped++;
             continue;
         }
 
-        static_cast<Element*>(cur_resource->get())->handle_event(update_event);
+        // Perform the text update. Swapping keeps both buffers' allocations around for the next assignment.
+        cur_element->base->SetInnerRML(cur_element->pending_text);
+        std::swap(cur_element->current_text, cur_element->pending_text);
+        ctx->frame_stats.text_updates++;
+        ctx->layout_dirty.store(true, std::memory_order_relaxed);
+    }
+    ctx->processing_text.clear();
+
+    // There's no layout phase, as RmlUi lays the document out once in Rml::Context::Update after this no matter how
+    // many layout-affecting properties the phases above changed.
+
+    ctx->update_stats = ctx->frame_stats;
+    ctx->frame_stats = {};
+}
+
+recompui::ResourceOriginScope::ResourceOriginScope(const char* origin) {
+    prev_origin = resource_origin;
+    resource_origin = origin;
+}
+
+recompui::ResourceOriginScope::~ResourceOriginScope() {
+    resource_origin = prev_origin;
+}
+
+std::vector<recompui::TrackedResource> recompui::ContextId::find_orphaned_resources_impl() {
+    Context* ctx = opened_context;
+    std::vector<TrackedResource> ret{};
+    if (ctx->resource_records.empty()) {
+        return ret;
+    }
+
+    std::unordered_set<const Element*> live_elements{};
+    live_elements.emplace(&ctx->root_element);
+    for (const auto& resource : ctx->resources) {
+        if (resource != nullptr && resource->is_element()) {
+            live_elements.emplace(static_cast<const Element*>(resource.get()));
+        }
     }
 
-    std::vector<std::tuple<ResourceId, std::string>> to_set_text = std::move(opened_context->to_set_text);
+    for (const auto& [resource_id, record] : ctx->resource_records) {
+        if (!record.is_element) {
+            continue;
+        }
 
-    // Set the text of Rml elements that have pending text assignments.
-    for (auto cur_text_update : to_set_text) {
-        ResourceId resource = std::get<0>(cur_text_update);
-        std::string& text = std::get<1>(cur_text_update);
+        Element* element = get_context_element(ctx, resource_id);
+        if (element == nullptr) {
+            continue;
+        }
 
-        assert(resource != ResourceId::null());
+        // An element is orphaned if its parent was destroyed, it was removed from its parent without being destroyed,
+        // or it was never given a parent and isn't owned by the context as a loose element.
+        bool orphaned = false;
+        Element* parent = element->parent;
+        if (parent == nullptr) {
+            orphaned = std::find(ctx->loose_elements.begin(), ctx->loose_elements.end(), element) == ctx->loose_elements.end();
+        }
+        // The parent pointer may be dangling, so check that it's still alive before looking at it.
+        else if (!live_elements.contains(parent)) {
+            orphaned = true;
+        }
+        // Children of the root document are tracked as loose elements instead of through the root's child list.
+        else if (parent != &ctx->root_element) {
+            orphaned = std::find(parent->children.begin(), parent->children.end(), element) == parent->children.end();
+        }
+
+        if (orphaned) {
+            ret.emplace_back(TrackedResource{
+                .resource = resource_id,
+                .type_name = std::string{ element->get_type_name() },
+                .origin = record.origin != nullptr ? record.origin : "unknown"
+            });
+        }
+    }
+
+    return ret;
+}
+
+recompui::ResourceStats recompui::ContextId::get_resource_stats() {
+    bool opened = open_if_not_already();
+    Context* ctx = opened_context;
+
+    ResourceStats ret{};
+    size_t memory = sizeof(Context);
+
+    // std::map nodes store the value alongside three pointers and a color, so count four pointers of overhead for each.
+    constexpr size_t property_entry_size = sizeof(std::pair<const Rml::PropertyId, Rml::Property>) + 4 * sizeof(void*);
+
+    for (const auto& resource : ctx->resources) {
+        // Skip slots that are still being filled in and the root element's placeholder.
+        if (resource == nullptr || resource->resource_id == ctx->root_element.resource_id) {
+            continue;
+        }
+
+        memory += sizeof(std::unique_ptr<Style>) + resource->property_map.size() * property_entry_size;
+
+        if (resource->is_element()) {
+            Element* element = static_cast<Element*>(resource.get());
+            ret.elements++;
+            ret.elements_by_type[std::string{ element->get_type_name() }]++;
+
+            memory += sizeof(Element);
+            memory += (element->children.capacity() + element->nav_children.capacity() + element->styles.capacity()) * sizeof(void*);
+            memory += element->styles_counter.capacity() * sizeof(uint32_t);
+            memory += element->callbacks.capacity() * sizeof(UICallback);
+            memory += element->id.capacity() + element->debug_id.capacity();
+            memory += element->pending_text.capacity() + element->current_text.capacity();
+        }
+        else {
+            ret.styles++;
+            memory += sizeof(Style);
+        }
+    }
+
+    ret.loose_elements = static_cast<uint32_t>(ctx->loose_elements.size());
+    ret.queued_updates = static_cast<uint32_t>(ctx->to_update.size());
+    ret.queued_text = static_cast<uint32_t>(ctx->to_set_text.size());
+
+    memory += ctx->loose_elements.capacity() * sizeof(Element*);
+    memory += (ctx->to_update.capacity() + ctx->processing_updates.capacity() + ctx->to_set_text.capacity() + ctx->processing_text.capacity()) * sizeof(ResourceId);
+    memory += ctx->update_order.capacity() * sizeof(std::pair<uint32_t, ResourceId>);
+    memory += ctx->elements_by_base.size() * (sizeof(std::pair<Rml::Element* const, ResourceId>) + 2 * sizeof(void*));
+    memory += ctx->resource_records.size() * (sizeof(std::pair<const ResourceId, ResourceRecord>) + 2 * sizeof(void*));
+    ret.approximate_memory = memory;
+
+    if (ctx->track_resources) {
+        ret.orphaned_elements = static_cast<uint32_t>(find_orphaned_resources_impl().size());
+    }
+
+    if (opened) {
+        close();
+    }
+
+    return ret;
+}
+
+void recompui::ContextId::set_resource_tracking(bool enabled) {
+    bool opened = open_if_not_already();
+
+    opened_context->track_resources = enabled;
+    if (!enabled) {
+        opened_context->resource_records.clear();
+    }
+
+    if (opened) {
+        close();
+    }
+}
+
+std::vector<recompui::TrackedResource> recompui::ContextId::get_orphaned_resources() {
+    bool opened = open_if_not_already();
+
+    std::vector<TrackedResource> ret = find_orphaned_resources_impl();
+
+    if (opened) {
+        close();
+    }
+
+    return ret;
+}
+
+recompui::UpdateStats recompui::ContextId::get_update_stats() {
+    std::lock_guard lock{ context_state.all_contexts_lock };
+
+    Context* ctx = context_state.all_contexts.get(context_slotmap::key{ slot_id });
+    if (ctx == nullptr) {
+        return {};
+    }
+
+    return ctx->update_stats;
+}
+
+void recompui::ContextId::start_animation(Element* element, Style* target, const AnimationTrack& track) {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::UpdateElementWithoutContext);
+    }
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::UpdateElementInWrongContext);
+    }
+
+    std::chrono::high_resolution_clock::duration now = get_animation_clock();
+
+    for (ActiveAnimation& animation : opened_context->animations) {
+        if (animation.element == element->resource_id && animation.target == target && animation.track.get_property() == track.get_property()) {
+            animation.track = track;
+            animation.start_time = now;
+            animation.last_value.reset();
+            return;
+        }
+    }
+
+    opened_context->animations.emplace_back(ActiveAnimation{ element->resource_id, target, track, now, std::nullopt });
+}
+
+void recompui::ContextId::stop_animations(Element* element, Style* target) {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::UpdateElementWithoutContext);
+    }
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::UpdateElementInWrongContext);
+    }
+
+    std::erase_if(opened_context->animations, [element, target](const ActiveAnimation& animation) {
+        return animation.element == element->resource_id && (target == nullptr || animation.target == target);
+    });
+}
+
+void recompui::ContextId::process_animations() {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::InternalError);
+    }
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::InternalError);
+    }
+
+    Context* ctx = opened_context;
+    std::chrono::high_resolution_clock::duration now = get_animation_clock();
+
+    size_t kept_count = 0;
+    for (size_t i = 0; i < ctx->animations.size(); i++) {
+        ActiveAnimation& animation = ctx->animations[i];
+
+        // Drop animations for elements that have been destroyed, which also owned the animated style.
+        Element* element = get_context_element(ctx, animation.element);
+        if (element == nullptr) {
+            continue;
+        }
+
+        std::chrono::high_resolution_clock::duration elapsed = animation.track.is_synchronized() ? now : now - animation.start_time;
+        float elapsed_ms = std::max(std::chrono::duration<float, std::milli>(elapsed).count(), 0.0f);
+
+        Rml::Property value = animation.track.sample(elapsed_ms);
+        if (!animation.last_value.has_value() || *animation.last_value != value) {
+            for (Rml::PropertyId property_id : animation.track.get_property_ids()) {
+                element->apply_animated_property(animation.target, property_id, value);
+            }
+            animation.last_value = value;
+        }
+
+        if (animation.track.is_finished(elapsed_ms)) {
+            continue;
+        }
+
+        if (kept_count != i) {
+            ctx->animations[kept_count] = std::move(animation);
+        }
+        kept_count++;
+    }
+
+    ctx->animations.erase(ctx->animations.begin() + kept_count, ctx->animations.end());
+}
+
+void recompui::ContextId::add_data_binding(Element* element, const DataBinding& binding) {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::UpdateElementWithoutContext);
+    }
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::UpdateElementInWrongContext);
+    }
+
+    for (ActiveDataBinding& data_binding : opened_context->data_bindings) {
+        if (data_binding.element == element->resource_id && data_binding.binding.get_property() == binding.get_property()) {
+            data_binding.binding = binding;
+            return;
+        }
+    }
+
+    opened_context->data_bindings.emplace_back(ActiveDataBinding{ element->resource_id, binding });
+}
+
+void recompui::ContextId::remove_data_binding(Element* element, DataBindingProperty property) {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::UpdateElementWithoutContext);
+    }
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::UpdateElementInWrongContext);
+    }
+
+    std::erase_if(opened_context->data_bindings, [element, property](const ActiveDataBinding& data_binding) {
+        return data_binding.element == element->resource_id && data_binding.binding.get_property() == property;
+    });
+}
+
+void recompui::ContextId::process_data_bindings() {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::InternalError);
+    }
 
-        resource_slotmap::key cur_key{ resource.slot_id };
-        std::unique_ptr<Style>* cur_resource = opened_context->resources.get(cur_key);
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::InternalError);
+    }
+
+    Context* ctx = opened_context;
+
+    size_t kept_count = 0;
+    for (size_t i = 0; i < ctx->data_bindings.size(); i++) {
+        ActiveDataBinding& data_binding = ctx->data_bindings[i];
 
-        // Make sure the resource exists before setting its text, as it may have been deleted.
-        if (cur_resource == nullptr) {
+        // Drop bindings for elements that have been destroyed.
+        Element* element = get_context_element(ctx, data_binding.element);
+        if (element == nullptr) {
             continue;
         }
 
-        // Perform the text update.
-        static_cast<Element*>(cur_resource->get())->base->SetInnerRML(text);
+        data_binding.binding.update(element);
+
+        if (kept_count != i) {
+            ctx->data_bindings[kept_count] = std::move(data_binding);
+        }
+        kept_count++;
+    }
+
+    ctx->data_bindings.erase(ctx->data_bindings.begin() + kept_count, ctx->data_bindings.end());
+}
+
+// Reads state that's only modified with the context open, without opening it. If the context is open on another thread its
+// state can't be read safely, so the busy result is returned instead. Returns false if the context doesn't exist.
+template <typename Func>
+static bool peek_context_state(recompui::ContextId context, bool busy_result, Func&& func) {
+    if (opened_context_id == context) {
+        return func(*opened_context);
+    }
+
+    std::lock_guard lock{ context_state.all_contexts_lock };
+
+    recompui::Context* ctx = context_state.all_contexts.get(context_slotmap::key{ context.slot_id });
+    if (ctx == nullptr) {
+        return false;
+    }
+
+    if (!ctx->context_lock.try_lock()) {
+        return busy_result;
+    }
+
+    bool ret = func(*ctx);
+    ctx->context_lock.unlock();
+    return ret;
+}
+
+bool recompui::ContextId::is_animating() {
+    // A context that's busy on another thread may be starting an animation, so report it as animating.
+    return peek_context_state(*this, true, [](Context& ctx) { return !ctx.animations.empty(); });
+}
+
+bool recompui::ContextId::has_frame_work() {
+    return peek_context_state(*this, true, [](Context& ctx) {
+        return !ctx.data_bindings.empty() || !ctx.to_update.empty() || !ctx.to_set_text.empty();
+    });
+}
+
+// Runs a function on this context's generation counter without requiring the context to be open.
+// Does nothing if the context doesn't exist, as there's no cached state left to invalidate.
+template <typename Func>
+static void with_generations(recompui::ContextId context, Func&& func) {
+    if (context == recompui::ContextId::null()) {
+        return;
+    }
+
+    if (opened_context_id == context) {
+        func(*opened_context);
+        return;
     }
+
+    std::lock_guard lock{ context_state.all_contexts_lock };
+
+    recompui::Context* ctx = context_state.all_contexts.get(context_slotmap::key{ context.slot_id });
+    if (ctx != nullptr) {
+        func(*ctx);
+    }
+}
+
+void recompui::ContextId::invalidate_navigation() {
+    with_generations(*this, [](Context& ctx) { ctx.navigation_generation.fetch_add(1, std::memory_order_relaxed); });
+}
+
+uint32_t recompui::ContextId::get_navigation_generation() {
+    uint32_t ret = 0;
+    with_generations(*this, [&ret](Context& ctx) { ret = ctx.navigation_generation.load(std::memory_order_relaxed); });
+    return ret;
+}
+
+void recompui::ContextId::invalidate_layout() {
+    with_generations(*this, [](Context& ctx) { ctx.layout_generation.fetch_add(1, std::memory_order_relaxed); });
+}
+
+void recompui::ContextId::mark_layout_dirty() {
+    with_generations(*this, [](Context& ctx) { ctx.layout_dirty.store(true, std::memory_order_relaxed); });
+}
+
+bool recompui::ContextId::take_layout_changes() {
+    bool ret = false;
+    with_generations(*this, [&ret](Context& ctx) { ret = ctx.layout_dirty.exchange(false, std::memory_order_relaxed); });
+    return ret;
+}
+
+uint32_t recompui::ContextId::get_layout_generation() {
+    uint32_t ret = 0;
+    with_generations(*this, [&ret](Context& ctx) { ret = ctx.layout_generation.load(std::memory_order_relaxed); });
+    return ret;
 }
 
 bool recompui::ContextId::captures_input() {
@@ -574,11 +1160,16 @@ recompui::Style* recompui::ContextId::add_resource_impl(ResourceId rid, std::uni
     // Move the resource into the allocated slot.
     *opened_context->resources.get(key) = std::move(resource);
 
+    if (opened_context->track_resources) {
+        opened_context->resource_records.insert_or_assign(rid, ResourceRecord{ .origin = resource_origin, .is_element = is_element });
+    }
+
     if (is_element) {
         Element* element_ptr = static_cast<Element*>(resource_ptr);
-        element_ptr->set_id(std::string{element_ptr->get_type_name()} + "-" + std::to_string(key.raw));
+        element_ptr->owning_context = *this;
+        opened_context->elements_by_base.insert_or_assign(element_ptr->base, rid);
         // Send one update to the element.
-        opened_context->to_update.emplace(ResourceId{ key.raw });
+        schedule_element_update(element_ptr);
     }
 
     return resource_ptr;
@@ -598,6 +1189,61 @@ void recompui::ContextId::add_loose_element(Element* element) {
     opened_context->loose_elements.emplace_back(element);
 }
 
+bool recompui::ContextId::remove_loose_element(Element* element) {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::AttachElementWithoutOpen);
+    }
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::AttachElementInWrongContext);
+    }
+
+    std::vector<Element*>& loose_elements = opened_context->loose_elements;
+    auto it = std::find(loose_elements.begin(), loose_elements.end(), element);
+    if (it == loose_elements.end()) {
+        return false;
+    }
+
+    loose_elements.erase(it);
+    return true;
+}
+
+void recompui::ContextId::attach_element(Element* element, Element* parent) {
+    // Take the context lock once for the whole attach if the caller doesn't already hold it. Everything below runs
+    // against the open context without touching any other lock.
+    bool opened = open_if_not_already();
+
+    // Only elements that have no parent and still own their Rml element can be attached.
+    if (element == nullptr || parent == nullptr || element == parent || element->parent != nullptr || !element->base_owning) {
+        context_error(*this, ContextErrorType::AttachElementNotDetached);
+    }
+
+    // The parent can't be inside the element's own subtree, as that would make the subtree own itself.
+    for (Element* ancestor = parent; ancestor != nullptr; ancestor = ancestor->parent) {
+        if (ancestor == element) {
+            context_error(*this, ContextErrorType::AttachElementNotDetached);
+        }
+    }
+
+    element->set_parent(parent);
+
+    if (opened) {
+        close();
+    }
+}
+
+bool recompui::ContextId::destroy_detached_element(Element* element) {
+    // remove_loose_element checks that this context is the one that's open.
+    if (element == nullptr || element->parent != nullptr || !remove_loose_element(element)) {
+        return false;
+    }
+
+    destroy_resource(element);
+    return true;
+}
+
 void recompui::ContextId::queue_element_update(ResourceId element) {
     // Ensure a context is currently opened by this thread.
     if (opened_context_id == ContextId::null()) {
@@ -615,10 +1261,27 @@ void recompui::ContextId::queue_element_update(ResourceId element) {
         context_error(*this, ContextErrorType::UpdateElementInWrongContext);
     }
 
-    opened_context->to_update.emplace(element);
+    // Elements that are still being constructed don't have their slot filled in yet. They'll be queued
+    // for an update once they're added to the context, so there's nothing to do for them here.
+    Element* element_ptr = get_context_element(opened_context, element);
+    if (element_ptr == nullptr) {
+        return;
+    }
+
+    schedule_element_update(element_ptr);
 }
 
-void recompui::ContextId::queue_set_text(Element* element, std::string&& text) {
+void recompui::ContextId::schedule_element_update(Element* element) {
+    // Skip elements that are already queued, which keeps each element in the update list only once.
+    if (element->update_queued) {
+        return;
+    }
+
+    element->update_queued = true;
+    opened_context->to_update.emplace_back(element->resource_id);
+}
+
+void recompui::ContextId::queue_set_text(Element* element) {
     // Ensure a context is currently opened by this thread.
     if (opened_context_id == ContextId::null()) {
         context_error(*this, ContextErrorType::SetTextElementWithoutContext);
@@ -629,7 +1292,20 @@ void recompui::ContextId::queue_set_text(Element* element, std::string&& text) {
         context_error(*this, ContextErrorType::SetTextElementInWrongContext);
     }
 
-    opened_context->to_set_text.emplace_back(std::make_tuple(element->resource_id, std::move(text)));
+    // The element is already queued, so the new pending text replaces the previous one.
+    if (element->text_queued) {
+        opened_context->frame_stats.text_updates_coalesced++;
+        return;
+    }
+
+    // The element already contains this text, so there's nothing to update.
+    if (element->pending_text == element->current_text) {
+        opened_context->frame_stats.text_updates_skipped++;
+        return;
+    }
+
+    element->text_queued = true;
+    opened_context->to_set_text.emplace_back(element->resource_id);
 }
 
 recompui::Style* recompui::ContextId::create_style() {
@@ -658,6 +1334,18 @@ void recompui::ContextId::destroy_resource(ResourceId resource) {
         context_error(*this, ContextErrorType::DestroyResourceInWrongContext);
     }
 
+    opened_context->resource_records.erase(resource);
+
+    // Remove the element's entry from the Rml element lookup before it gets destroyed.
+    auto* cur_resource = opened_context->resources.get(resource_slotmap::key{ resource.slot_id });
+    if (cur_resource != nullptr && *cur_resource != nullptr && (*cur_resource)->is_element()) {
+        Element* element = static_cast<Element*>(cur_resource->get());
+        auto find_it = opened_context->elements_by_base.find(element->base);
+        if (find_it != opened_context->elements_by_base.end() && find_it->second == resource) {
+            opened_context->elements_by_base.erase(find_it);
+        }
+    }
+
     // Try to remove the resource from the current context.
     auto pop_result = opened_context->resources.pop(resource_slotmap::key{ resource.slot_id });
     if (!pop_result.has_value()) {
@@ -687,6 +1375,12 @@ void recompui::ContextId::clear_children() {
 }
 
 Rml::ElementDocument* recompui::ContextId::get_document() {
+    // The context that's open on this thread can't be destroyed until it's closed, so skip the global lock.
+    // This is hit by every element construction.
+    if (opened_context_id == *this) {
+        return opened_context->document;
+    }
+
     std::lock_guard lock{ context_state.all_contexts_lock };
 
     Context* ctx = context_state.all_contexts.get(context_slotmap::key{ slot_id });
@@ -746,6 +1440,10 @@ recompui::ContextId recompui::get_current_context() {
     return opened_context_id;
 }
 
+recompui::ContextId recompui::try_get_current_context() {
+    return opened_context_id;
+}
+
 recompui::Style* get_resource_from_current_context(resource_slotmap::key key) {
     // Ensure a context is currently opened by this thread.
     if (opened_context_id == recompui::ContextId::null()) {
@@ -823,11 +1521,38 @@ recompui::Element* recompui::ContextId::get_focused_element() {
         return nullptr;
     }
 
-    for (const auto& resource : opened_context->resources) {
-        recompui::Element *element = static_cast<Element*>(resource.get());
-        if (element->id == focused->GetId()) {
-            return element;
-        }
+    return get_element_from_base(focused);
+}
+
+recompui::Element* recompui::ContextId::get_element_from_base(Rml::Element* base) {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::GetResourceWithoutOpen);
     }
-    return nullptr;
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::GetResourceFailed);
+    }
+
+    auto find_it = opened_context->elements_by_base.find(base);
+    if (find_it == opened_context->elements_by_base.end()) {
+        return nullptr;
+    }
+
+    return get_context_element(opened_context, find_it->second);
+}
+
+bool recompui::ContextId::has_resource(ResourceId resource) {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::GetResourceWithoutOpen);
+    }
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::GetResourceFailed);
+    }
+
+    return opened_context->resources.get(resource_slotmap::key{ resource.slot_id }) != nullptr;
 }
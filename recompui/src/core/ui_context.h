@@ -5,6 +5,9 @@
 #include <utility>
 #include <filesystem>
 #include <functional>
+#include <map>
+#include <string>
+#include <vector>
 
 #include "RmlUi/Core.h"
 
@@ -14,9 +17,72 @@ namespace recompui {
     class Style;
     class Element;
     class Document;
+    class AnimationTrack;
+    class DataBinding;
+    enum class DataBindingProperty : uint32_t;
+
+    // Per-frame counters for a context's update scheduler. Covers everything queued since the previous call to process_updates.
+    struct UpdateStats {
+        // Number of elements that were queued for an update.
+        uint32_t queued_updates = 0;
+        // Number of update events that were dispatched to elements.
+        uint32_t update_events = 0;
+        // Number of queued updates that were dropped because the element was destroyed before processing.
+        uint32_t dropped_updates = 0;
+        // Number of text assignments that were applied to elements.
+        uint32_t text_updates = 0;
+        // Number of text assignments that replaced another pending assignment for the same element.
+        uint32_t text_updates_coalesced = 0;
+        // Number of text assignments that were dropped because the element already contained that text.
+        uint32_t text_updates_skipped = 0;
+    };
+
+    // Snapshot of the resources that are alive in a context, used to find leaks in long running sessions.
+    struct ResourceStats {
+        // Number of live styles that aren't elements.
+        uint32_t styles = 0;
+        // Number of live elements, excluding the context's root element.
+        uint32_t elements = 0;
+        // Number of live elements of each element type, keyed by the type's name.
+        std::map<std::string, uint32_t> elements_by_type;
+        // Number of elements that are owned by the context directly instead of by a parent element.
+        uint32_t loose_elements = 0;
+        // Number of elements waiting for an update or a text assignment.
+        uint32_t queued_updates = 0;
+        uint32_t queued_text = 0;
+        // Rough estimate of the memory used by the context's resources and bookkeeping, in bytes.
+        size_t approximate_memory = 0;
+        // Number of elements that outlived the parent they were created with. Only counted while resource tracking is enabled.
+        uint32_t orphaned_elements = 0;
+    };
+
+    // Information about a resource that was recorded while resource tracking was enabled.
+    struct TrackedResource {
+        ResourceId resource;
+        std::string type_name;
+        // Label of the code that created the resource, see ResourceOriginScope. Resources created by mods are labelled
+        // with the name of the export that created them. The mod itself is identified by the context, as each context
+        // belongs to a single mod.
+        std::string origin;
+    };
+
+    // Labels every resource created on this thread while it's alive with the given origin, which is reported
+    // by resource tracking. Scopes can be nested, in which case the innermost label is used.
+    class ResourceOriginScope {
+    public:
+        ResourceOriginScope(const char* origin);
+        ~ResourceOriginScope();
+        ResourceOriginScope(const ResourceOriginScope&) = delete;
+        ResourceOriginScope& operator=(const ResourceOriginScope&) = delete;
+    private:
+        const char* prev_origin;
+    };
+
     class ContextId {
         ResourceId create_resource_impl(bool is_element);
         Style* add_resource_impl(ResourceId rid, std::unique_ptr<Style>&& resource);
+        void schedule_element_update(Element* element);
+        std::vector<TrackedResource> find_orphaned_resources_impl();
         public:
         uint32_t slot_id;
         auto operator<=>(const ContextId& rhs) const = default;
@@ -33,9 +99,27 @@ namespace recompui {
             return static_cast<T*>(add_resource_impl(rid, std::make_unique<T>(rid, std::move(element))));
         }
 
+        // Creates an element that isn't attached to any parent. Children can be created under it as usual, and the
+        // whole subtree is built outside of the document until it's attached with attach_element. This avoids
+        // touching the live document for every element in a large composite.
+        template <typename T, typename... Args>
+        T* create_detached_element(Args... args) {
+            T* ret = create_element<T>(static_cast<Element*>(nullptr), std::forward<Args>(args)...);
+            add_loose_element(ret);
+            return ret;
+        }
+
+        // Attaches an element created with create_detached_element to a parent in a single operation. Opens the context
+        // for the duration of the attach if it isn't already open on this thread.
+        void attach_element(Element* element, Element* parent);
+        // Destroys an element created with create_detached_element that was never attached, along with its subtree.
+        // Returns false if the element isn't a detached element of this context.
+        bool destroy_detached_element(Element* element);
+
         void add_loose_element(Element* element);
+        bool remove_loose_element(Element* element);
         void queue_element_update(ResourceId element);
-        void queue_set_text(Element* element, std::string&& text);
+        void queue_set_text(Element* element);
 
         Style* create_style();
 
@@ -47,14 +131,74 @@ namespace recompui {
         Rml::ElementDocument* get_document();
         Document* get_root_element();
         Element* get_focused_element();
+        // Gets the element in this context that's backed by the given Rml element, or null if there isn't one.
+        Element* get_element_from_base(Rml::Element* base);
+        // Checks if a resource is still alive in this context, which must be open.
+        bool has_resource(ResourceId resource);
         Element* get_last_focused_element();
         Element* get_autofocus_element();
         void set_autofocus_element(Element* element);
 
+        // Checks if this context hasn't been destroyed.
+        bool exists();
         void open();
         bool open_if_not_already();
         void close();
+        // Keeps this context open after the current event is dispatched if an event dispatch batch is active.
+        // Returns false if there's no active batch, in which case the caller should close the context as usual.
+        bool hold_for_event_dispatch();
+        // Checks if this context is open because an event dispatch batch is holding it.
+        bool is_held_for_event_dispatch();
+        // Runs this frame's queued work in phases. Update events are dispatched first, parents before children, and
+        // that's where elements apply their style changes. Queued text is applied after that, so text set by update
+        // handlers lands in the same frame.
         void process_updates();
+        UpdateStats get_update_stats();
+
+        // Starts animating a property of a style owned by the given element, which may be the element itself.
+        // Replaces any animation that's already running for the same element, style and property.
+        void start_animation(Element* element, Style* target, const AnimationTrack& track);
+        // Stops the element's animations on the given style, or all of its animations if the style is null.
+        // Properties keep whatever value they were last animated to.
+        void stop_animations(Element* element, Style* target);
+        // Advances every running animation to the current animation clock time.
+        void process_animations();
+        // Checks if any animations are running in this context, which means it needs to be processed every frame.
+        bool is_animating();
+        // Checks if the context has data bindings to sample or queued updates or text, which process_data_bindings and
+        // process_updates handle. Together with is_animating, this tells whether the context has anything to do this frame.
+        bool has_frame_work();
+
+        // Marks the cached navigation tree of this context's document as stale.
+        void invalidate_navigation();
+        // Marks the cached geometry of this context's elements as stale. Called after RmlUi lays out a document that
+        // had changes to lay out, and by anything that moves elements without a layout pass.
+        void invalidate_layout();
+        // Records a change that RmlUi's next layout pass can move elements for, like a property or text change.
+        void mark_layout_dirty();
+        // Returns whether any changes were marked since the last call and clears them. Called right before RmlUi lays
+        // the document out, so changes marked during the layout pass are kept for the next one.
+        bool take_layout_changes();
+        // Generation counters for the caches above. These don't require the context to be open and return 0 if
+        // the context doesn't exist, which callers should treat as uncacheable.
+        uint32_t get_navigation_generation();
+        uint32_t get_layout_generation();
+
+        // Binds a property of an element to a value in rdram, replacing any existing binding for the same element and property.
+        void add_data_binding(Element* element, const DataBinding& binding);
+        void remove_data_binding(Element* element, DataBindingProperty property);
+        // Samples every data binding and applies the values that changed. Must run before process_updates so the changes
+        // are applied in the same frame.
+        void process_data_bindings();
+
+        // Gathers statistics about the resources that are alive in this context. Opens the context if it isn't already open.
+        ResourceStats get_resource_stats();
+        // Enables recording the origin and parent of every resource created in this context from now on.
+        // This has a cost for every resource creation, so it's meant for debugging leaks.
+        void set_resource_tracking(bool enabled);
+        // Gets the tracked elements whose parent has been destroyed or that were never given a parent.
+        // Only resources created while tracking was enabled are reported.
+        std::vector<TrackedResource> get_orphaned_resources();
 
         static constexpr ContextId null() { return ContextId{ .slot_id = uint32_t(-1) }; }
 
@@ -65,11 +209,27 @@ namespace recompui {
         void set_captures_mouse(bool captures_input);
     };
 
+    // While alive, the context used to dispatch an RmlUi event is kept open afterwards so that a burst of events for
+    // the same context (e.g. all of the events generated by one input) only opens and closes it once. The held context
+    // is closed when another context is opened on this thread, and when the outermost batch ends.
+    class EventDispatchBatch {
+    public:
+        EventDispatchBatch();
+        ~EventDispatchBatch();
+        EventDispatchBatch(const EventDispatchBatch&) = delete;
+        EventDispatchBatch& operator=(const EventDispatchBatch&) = delete;
+    };
+
+    // Closes the context held by the current event dispatch batch, if any.
+    void release_event_dispatch_context();
+
     ContextId create_context(const std::filesystem::path& path);
     ContextId create_context(Rml::ElementDocument* document);
     ContextId create_context();
     void destroy_context(ContextId id);
     ContextId get_current_context();
+    // Gets the context that's open on this thread, or null if there isn't one.
+    ContextId try_get_current_context();
     ContextId get_context_from_document(Rml::ElementDocument* document);
     void destroy_all_contexts();
 
@@ -0,0 +1,107 @@
+#include "ui_texture_registry.h"
+
+#include <charconv>
+#include <mutex>
+#include <vector>
+
+namespace recompui {
+
+    constexpr std::string_view texture_source_prefix = "?/mod_api/";
+    constexpr uint32_t texture_index_bits = 16;
+    constexpr uint32_t texture_index_mask = (1U << texture_index_bits) - 1;
+    constexpr uint32_t texture_generation_mask = 0xFFFF;
+
+    struct TextureSlot {
+        std::string source;
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    static struct {
+        std::mutex mutex;
+        std::vector<TextureSlot> slots;
+        std::vector<uint32_t> free_indices;
+    } texture_registry;
+
+    static TextureSlot *find_texture_slot(uint32_t handle) {
+        uint32_t index = (handle & texture_index_mask) - 1;
+        if ((handle & texture_index_mask) == 0 || index >= texture_registry.slots.size()) {
+            return nullptr;
+        }
+
+        TextureSlot &slot = texture_registry.slots[index];
+        if (!slot.alive || slot.generation != (handle >> texture_index_bits)) {
+            return nullptr;
+        }
+
+        return &slot;
+    }
+
+    uint32_t create_texture_handle() {
+        std::lock_guard lock{ texture_registry.mutex };
+
+        uint32_t index;
+        if (!texture_registry.free_indices.empty()) {
+            index = texture_registry.free_indices.back();
+            texture_registry.free_indices.pop_back();
+        }
+        else if (texture_registry.slots.size() < texture_index_mask) {
+            index = static_cast<uint32_t>(texture_registry.slots.size());
+            texture_registry.slots.emplace_back();
+        }
+        else {
+            return 0;
+        }
+
+        TextureSlot &slot = texture_registry.slots[index];
+        uint32_t handle = (slot.generation << texture_index_bits) | (index + 1);
+        slot.alive = true;
+        slot.source.assign(texture_source_prefix);
+        slot.source.append(std::to_string(handle));
+        return handle;
+    }
+
+    bool release_texture_handle(uint32_t handle) {
+        std::lock_guard lock{ texture_registry.mutex };
+
+        TextureSlot *slot = find_texture_slot(handle);
+        if (slot == nullptr) {
+            return false;
+        }
+
+        slot->alive = false;
+        slot->generation = (slot->generation + 1) & texture_generation_mask;
+        texture_registry.free_indices.emplace_back((handle & texture_index_mask) - 1);
+        return true;
+    }
+
+    bool is_texture_handle_alive(uint32_t handle) {
+        std::lock_guard lock{ texture_registry.mutex };
+
+        return find_texture_slot(handle) != nullptr;
+    }
+
+    bool get_texture_source(uint32_t handle, std::string &out) {
+        std::lock_guard lock{ texture_registry.mutex };
+
+        TextureSlot *slot = find_texture_slot(handle);
+        if (slot == nullptr) {
+            return false;
+        }
+
+        out = slot->source;
+        return true;
+    }
+
+    bool parse_texture_source(std::string_view source, uint32_t &handle) {
+        if (!source.starts_with(texture_source_prefix)) {
+            return false;
+        }
+
+        const char *begin = source.data() + texture_source_prefix.size();
+        const char *end = source.data() + source.size();
+        auto [ptr, ec] = std::from_chars(begin, end, handle);
+        return ec == std::errc{} && ptr == end && handle != 0;
+    }
+
+} // namespace recompui
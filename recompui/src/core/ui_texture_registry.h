@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace recompui {
+    // Textures created through the mod API are identified by integer handles, which are shared with the renderer and
+    // image elements so that neither has to look textures up by name. A handle holds its slot index plus one in the low
+    // 16 bits and the slot's generation in the bits above, so handles to destroyed textures are rejected even after
+    // their slot has been reused. 0 is never a valid handle.
+    uint32_t create_texture_handle();
+    // Returns false if the handle doesn't refer to a live texture.
+    bool release_texture_handle(uint32_t handle);
+    // Checks if the handle refers to a live texture without copying its source.
+    bool is_texture_handle_alive(uint32_t handle);
+    // Gets the source that RmlUi loads the texture through, which is built once when the texture is created.
+    // Returns false if the handle doesn't refer to a live texture.
+    bool get_texture_source(uint32_t handle, std::string &out);
+    // Gets the handle encoded in a texture source without looking anything up. Returns false if the source isn't
+    // for a mod texture, but doesn't check whether the texture is still alive.
+    bool parse_texture_source(std::string_view source, uint32_t &handle);
+} // namespace recompui
@@ -0,0 +1,214 @@
+#include "ultramodern/ultramodern.hpp"
+
+#include "ui_animation.h"
+#include "ui_utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+
+namespace recompui {
+
+    // Advanced by the UI thread and read by any thread that starts an animation with its context open.
+    static std::atomic<std::chrono::high_resolution_clock::duration> animation_clock{};
+
+    void advance_animation_clock() {
+        animation_clock.store(ultramodern::time_since_start(), std::memory_order_relaxed);
+    }
+
+    std::chrono::high_resolution_clock::duration get_animation_clock() {
+        return animation_clock.load(std::memory_order_relaxed);
+    }
+
+    float apply_easing(Easing easing, float t) {
+        t = std::clamp(t, 0.0f, 1.0f);
+        switch (easing) {
+        case Easing::Linear:
+            return t;
+        case Easing::QuadIn:
+            return t * t;
+        case Easing::QuadOut:
+            return 1.0f - (1.0f - t) * (1.0f - t);
+        case Easing::QuadInOut:
+            return t < 0.5f ? 2.0f * t * t : 1.0f - 2.0f * (1.0f - t) * (1.0f - t);
+        case Easing::CubicIn:
+            return t * t * t;
+        case Easing::CubicOut:
+            return 1.0f - (1.0f - t) * (1.0f - t) * (1.0f - t);
+        case Easing::CubicInOut:
+            return t < 0.5f ? 4.0f * t * t * t : 1.0f - 4.0f * (1.0f - t) * (1.0f - t) * (1.0f - t);
+        case Easing::SineInOut:
+            return 0.5f - 0.5f * std::cos(t * 3.14159265f);
+        default:
+            assert(false && "Unknown easing.");
+            return t;
+        }
+    }
+
+    static Rml::Unit to_rml(Unit unit) {
+        switch (unit) {
+        case Unit::Px:
+            return Rml::Unit::PX;
+        case Unit::Dp:
+            return Rml::Unit::DP;
+        case Unit::Percent:
+            return Rml::Unit::PERCENT;
+        default:
+            return Rml::Unit::UNKNOWN;
+        }
+    }
+
+    AnimationTrack::AnimationTrack(AnimatedProperty property, Unit unit) : property(property), unit(unit) {}
+
+    AnimationTrack AnimationTrack::tween(AnimatedProperty property, float from, float to, float duration_ms, Easing easing, Unit unit) {
+        AnimationTrack track{ property, unit };
+        track.add_keyframe(0.0f, from);
+        track.add_keyframe(duration_ms, to, easing);
+        return track;
+    }
+
+    AnimationTrack AnimationTrack::tween(AnimatedProperty property, const Color &from, const Color &to, float duration_ms, Easing easing) {
+        AnimationTrack track{ property };
+        track.add_keyframe(0.0f, from);
+        track.add_keyframe(duration_ms, to, easing);
+        return track;
+    }
+
+    AnimationTrack &AnimationTrack::add_keyframe(float time_ms, float value, Easing easing) {
+        assert(!is_color() && "Numeric keyframe added to a color track.");
+        assert((keyframes.empty() || time_ms >= keyframes.back().time_ms) && "Keyframes must be added in order.");
+        keyframes.emplace_back(Keyframe{ time_ms, value, Color{}, easing });
+        return *this;
+    }
+
+    AnimationTrack &AnimationTrack::add_keyframe(float time_ms, const Color &value, Easing easing) {
+        assert(is_color() && "Color keyframe added to a numeric track.");
+        assert((keyframes.empty() || time_ms >= keyframes.back().time_ms) && "Keyframes must be added in order.");
+        keyframes.emplace_back(Keyframe{ time_ms, 0.0f, value, easing });
+        return *this;
+    }
+
+    bool AnimationTrack::is_color() const {
+        switch (property) {
+        case AnimatedProperty::Color:
+        case AnimatedProperty::BackgroundColor:
+        case AnimatedProperty::BorderColor:
+        case AnimatedProperty::ImageColor:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    std::span<const Rml::PropertyId> AnimationTrack::get_property_ids() const {
+        static const Rml::PropertyId left[] = { Rml::PropertyId::Left };
+        static const Rml::PropertyId top[] = { Rml::PropertyId::Top };
+        static const Rml::PropertyId right[] = { Rml::PropertyId::Right };
+        static const Rml::PropertyId bottom[] = { Rml::PropertyId::Bottom };
+        static const Rml::PropertyId width[] = { Rml::PropertyId::Width };
+        static const Rml::PropertyId height[] = { Rml::PropertyId::Height };
+        static const Rml::PropertyId opacity[] = { Rml::PropertyId::Opacity };
+        static const Rml::PropertyId color[] = { Rml::PropertyId::Color };
+        static const Rml::PropertyId background_color[] = { Rml::PropertyId::BackgroundColor };
+        static const Rml::PropertyId border_color[] = {
+            Rml::PropertyId::BorderTopColor,
+            Rml::PropertyId::BorderBottomColor,
+            Rml::PropertyId::BorderLeftColor,
+            Rml::PropertyId::BorderRightColor
+        };
+        static const Rml::PropertyId image_color[] = { Rml::PropertyId::ImageColor };
+
+        switch (property) {
+        case AnimatedProperty::Left:
+            return left;
+        case AnimatedProperty::Top:
+            return top;
+        case AnimatedProperty::Right:
+            return right;
+        case AnimatedProperty::Bottom:
+            return bottom;
+        case AnimatedProperty::Width:
+            return width;
+        case AnimatedProperty::Height:
+            return height;
+        case AnimatedProperty::Opacity:
+            return opacity;
+        case AnimatedProperty::Color:
+            return color;
+        case AnimatedProperty::BackgroundColor:
+            return background_color;
+        case AnimatedProperty::BorderColor:
+            return border_color;
+        case AnimatedProperty::ImageColor:
+            return image_color;
+        default:
+            assert(false && "Unknown animated property.");
+            return {};
+        }
+    }
+
+    bool AnimationTrack::is_finished(float elapsed_ms) const {
+        return repeat == AnimationRepeat::Once && elapsed_ms >= get_duration_ms();
+    }
+
+    Rml::Property AnimationTrack::sample(float elapsed_ms) const {
+        assert(!keyframes.empty() && "Sampled an animation track without keyframes.");
+
+        // Map the elapsed time into the track's duration based on the repeat mode.
+        float duration = get_duration_ms();
+        float time = elapsed_ms;
+        if (duration > 0.0f) {
+            switch (repeat) {
+            case AnimationRepeat::Once:
+                time = std::min(elapsed_ms, duration);
+                break;
+            case AnimationRepeat::Loop:
+                time = std::fmod(elapsed_ms, duration);
+                break;
+            case AnimationRepeat::Yoyo:
+                time = std::fmod(elapsed_ms, duration * 2.0f);
+                if (time > duration) {
+                    time = duration * 2.0f - time;
+                }
+                break;
+            }
+        }
+        else {
+            time = 0.0f;
+        }
+
+        // Find the keyframe pair surrounding the time. The first keyframe is used as-is before its time.
+        auto next_it = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+            [](float t, const Keyframe &keyframe) { return t < keyframe.time_ms; });
+
+        const Keyframe *from;
+        const Keyframe *to;
+        float factor;
+        if (next_it == keyframes.begin()) {
+            from = to = &keyframes.front();
+            factor = 0.0f;
+        }
+        else if (next_it == keyframes.end()) {
+            from = to = &keyframes.back();
+            factor = 0.0f;
+        }
+        else {
+            from = &*(next_it - 1);
+            to = &*next_it;
+            factor = apply_easing(to->easing, (time - from->time_ms) / (to->time_ms - from->time_ms));
+        }
+
+        if (is_color()) {
+            Color color = lerp_color(from->color, to->color, factor);
+            return Rml::Property(Rml::Colourb(color.r, color.g, color.b, color.a), Rml::Unit::COLOUR);
+        }
+
+        float value = std::lerp(from->number, to->number, factor);
+        if (property == AnimatedProperty::Opacity) {
+            return Rml::Property(value, Rml::Unit::NUMBER);
+        }
+        return Rml::Property(value, to_rml(unit));
+    }
+
+} // namespace recompui
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <span>
+#include <vector>
+
+#include "RmlUi/Core.h"
+
+#include "ui_types.h"
+
+namespace recompui {
+
+    // A single property animated between keyframes. A tween is a track with two keyframes.
+    class AnimationTrack {
+    public:
+        struct Keyframe {
+            float time_ms;
+            float number;
+            Color color;
+            // Easing used when interpolating from the previous keyframe to this one.
+            Easing easing;
+        };
+
+        AnimationTrack(AnimatedProperty property, Unit unit = Unit::Dp);
+        static AnimationTrack tween(AnimatedProperty property, float from, float to, float duration_ms, Easing easing = Easing::Linear, Unit unit = Unit::Dp);
+        static AnimationTrack tween(AnimatedProperty property, const Color &from, const Color &to, float duration_ms, Easing easing = Easing::Linear);
+
+        // Keyframes must be added in increasing time order.
+        AnimationTrack &add_keyframe(float time_ms, float value, Easing easing = Easing::Linear);
+        AnimationTrack &add_keyframe(float time_ms, const Color &value, Easing easing = Easing::Linear);
+        AnimationTrack &set_repeat(AnimationRepeat repeat) { this->repeat = repeat; return *this; }
+        // Measures the track's time from the start of the animation clock instead of from when it was started,
+        // so every synchronized track with the same duration stays in phase.
+        AnimationTrack &set_synchronized(bool synchronized) { this->synchronized = synchronized; return *this; }
+
+        AnimatedProperty get_property() const { return property; }
+        // Rml properties written by the track. Border colors are applied to all four sides.
+        std::span<const Rml::PropertyId> get_property_ids() const;
+        AnimationRepeat get_repeat() const { return repeat; }
+        bool is_synchronized() const { return synchronized; }
+        float get_duration_ms() const { return keyframes.empty() ? 0.0f : keyframes.back().time_ms; }
+        // Returns true if a non-repeating track has reached its last keyframe at the given time.
+        bool is_finished(float elapsed_ms) const;
+        // Computes the property's value at the given time since the track started.
+        Rml::Property sample(float elapsed_ms) const;
+    private:
+        AnimatedProperty property;
+        Unit unit;
+        AnimationRepeat repeat = AnimationRepeat::Once;
+        bool synchronized = false;
+        std::vector<Keyframe> keyframes;
+
+        bool is_color() const;
+    };
+
+    float apply_easing(Easing easing, float t);
+
+    // The animation clock is sampled once per frame so every animation in every context advances by the same amount.
+    void advance_animation_clock();
+    std::chrono::high_resolution_clock::duration get_animation_clock();
+
+} // namespace recompui
@@ -197,6 +197,7 @@ namespace recompui {
     }
 
     void Button::set_text(std::string_view text) {
+        clear_interned_text();
         label->set_text(text);
     }
 };
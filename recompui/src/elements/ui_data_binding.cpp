@@ -0,0 +1,193 @@
+#include "ui_data_binding.h"
+#include "ui_element.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+namespace recompui {
+
+    static bool is_float_type(DataBindingType type) {
+        return type == DataBindingType::F32;
+    }
+
+    static bool is_signed_type(DataBindingType type) {
+        switch (type) {
+        case DataBindingType::S8:
+        case DataBindingType::S16:
+        case DataBindingType::S32:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static bool is_integer_conversion(char c) {
+        return strchr("diuxXo", c) != nullptr;
+    }
+
+    static bool is_float_conversion(char c) {
+        return strchr("fFeEgGaA", c) != nullptr;
+    }
+
+    // Finds the conversion character of the single conversion in a format, or returns npos if there isn't exactly one.
+    static size_t find_conversion(std::string_view format) {
+        size_t conversion = std::string_view::npos;
+
+        for (size_t i = 0; i < format.size(); i++) {
+            if (format[i] != '%') {
+                continue;
+            }
+
+            i++;
+            if (i < format.size() && format[i] == '%') {
+                continue;
+            }
+
+            while (i < format.size() && strchr("-+ #0", format[i]) != nullptr) {
+                i++;
+            }
+            while (i < format.size() && format[i] >= '0' && format[i] <= '9') {
+                i++;
+            }
+            if (i < format.size() && format[i] == '.') {
+                i++;
+                while (i < format.size() && format[i] >= '0' && format[i] <= '9') {
+                    i++;
+                }
+            }
+
+            if (i >= format.size() || conversion != std::string_view::npos) {
+                return std::string_view::npos;
+            }
+
+            conversion = i;
+        }
+
+        return conversion;
+    }
+
+    DataBinding::DataBinding(DataBindingProperty property, DataBindingType type, uint8_t* rdram, gpr address, std::string_view format) :
+        property(property), type(type), rdram(rdram), address(address)
+    {
+        if (property != DataBindingProperty::Text) {
+            return;
+        }
+
+        size_t conversion = find_conversion(format);
+        assert(conversion != std::string_view::npos && "Data binding format wasn't validated.");
+
+        this->format.assign(format.substr(0, conversion));
+        if (!is_float_type(type)) {
+            this->format.append("ll");
+            unsigned_conversion = format[conversion] != 'd' && format[conversion] != 'i';
+        }
+        this->format.append(format.substr(conversion));
+    }
+
+    uint32_t DataBinding::get_type_size(DataBindingType type) {
+        switch (type) {
+        case DataBindingType::U8:
+        case DataBindingType::S8:
+            return 1;
+        case DataBindingType::U16:
+        case DataBindingType::S16:
+            return 2;
+        case DataBindingType::U32:
+        case DataBindingType::S32:
+        case DataBindingType::F32:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    bool DataBinding::is_valid_format(std::string_view format, DataBindingType type) {
+        size_t conversion = find_conversion(format);
+        if (conversion == std::string_view::npos) {
+            return false;
+        }
+
+        return is_float_type(type) ? is_float_conversion(format[conversion]) : is_integer_conversion(format[conversion]);
+    }
+
+    uint32_t DataBinding::read_raw() const {
+        switch (type) {
+        case DataBindingType::U8:
+        case DataBindingType::S8:
+            return static_cast<uint8_t>(MEM_B(0, address));
+        case DataBindingType::U16:
+        case DataBindingType::S16:
+            return static_cast<uint16_t>(MEM_H(0, address));
+        default:
+            return static_cast<uint32_t>(MEM_W(0, address));
+        }
+    }
+
+    static int32_t sign_extend(uint32_t raw, DataBindingType type) {
+        switch (type) {
+        case DataBindingType::S8:
+            return static_cast<int8_t>(raw);
+        case DataBindingType::S16:
+            return static_cast<int16_t>(raw);
+        default:
+            return static_cast<int32_t>(raw);
+        }
+    }
+
+    static float raw_to_float(uint32_t raw) {
+        float ret;
+        memcpy(&ret, &raw, sizeof(ret));
+        return ret;
+    }
+
+    void DataBinding::format_text(uint32_t raw, std::string &out) const {
+        char buffer[256];
+        int length;
+        if (is_float_type(type)) {
+            length = snprintf(buffer, sizeof(buffer), format.c_str(), static_cast<double>(raw_to_float(raw)));
+        }
+        else if (unsigned_conversion || !is_signed_type(type)) {
+            length = snprintf(buffer, sizeof(buffer), format.c_str(), static_cast<unsigned long long>(raw));
+        }
+        else {
+            length = snprintf(buffer, sizeof(buffer), format.c_str(), static_cast<long long>(sign_extend(raw, type)));
+        }
+
+        out.assign(buffer, std::clamp(length, 0, static_cast<int>(sizeof(buffer)) - 1));
+    }
+
+    void DataBinding::update(Element* element) {
+        uint32_t raw = read_raw();
+        if (has_value && raw == last_raw) {
+            return;
+        }
+
+        has_value = true;
+        last_raw = raw;
+
+        switch (property) {
+        case DataBindingProperty::Text: {
+            std::string text;
+            format_text(raw, text);
+            element->set_text(text);
+            break;
+        }
+        case DataBindingProperty::Value:
+            if (is_float_type(type)) {
+                element->set_input_value_float(raw_to_float(raw));
+            }
+            else {
+                element->set_input_value_u32(static_cast<uint32_t>(sign_extend(raw, type)));
+            }
+            break;
+        case DataBindingProperty::Visibility: {
+            bool visible = is_float_type(type) ? raw_to_float(raw) != 0.0f : raw != 0;
+            element->set_visibility(visible ? Visibility::Visible : Visibility::Hidden);
+            break;
+        }
+        }
+    }
+
+} // namespace recompui
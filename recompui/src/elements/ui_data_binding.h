@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "recomp.h"
+
+namespace recompui {
+    class Element;
+
+    // Element properties that can be bound to rdram.
+    enum class DataBindingProperty : uint32_t {
+        Text = 0,
+        Value = 1,
+        Visibility = 2,
+    };
+
+    enum class DataBindingType : uint32_t {
+        U8 = 0,
+        S8 = 1,
+        U16 = 2,
+        S16 = 3,
+        U32 = 4,
+        S32 = 5,
+        F32 = 6,
+    };
+
+    // Drives a property of an element from a value in rdram. The value is sampled once per frame and the property is
+    // only written when the value changes, so an unchanging value costs a single read.
+    class DataBinding {
+    public:
+        // The format is only used by text bindings and must already have been checked with is_valid_format.
+        DataBinding(DataBindingProperty property, DataBindingType type, uint8_t* rdram, gpr address, std::string_view format);
+        DataBindingProperty get_property() const { return property; }
+        // Reads the value and writes it to the element's property if it changed since the last update.
+        void update(Element* element);
+
+        static uint32_t get_type_size(DataBindingType type);
+        // Checks that a printf format has exactly one conversion and that it matches the type. Only flags, width and
+        // precision are allowed in the conversion, as the length modifier is picked based on the type.
+        static bool is_valid_format(std::string_view format, DataBindingType type);
+    private:
+        DataBindingProperty property;
+        DataBindingType type;
+        uint8_t* rdram;
+        gpr address;
+        // The format with a length modifier inserted into its conversion.
+        std::string format;
+        bool unsigned_conversion = false;
+        bool has_value = false;
+        uint32_t last_raw = 0;
+
+        uint32_t read_raw() const;
+        void format_text(uint32_t raw, std::string &out) const;
+    };
+
+} // namespace recompui
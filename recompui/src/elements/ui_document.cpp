@@ -1,6 +1,10 @@
 #include "elements/ui_document.h"
 #include "recompui/recompui.h"
 
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
 // This define shows debug output for the navigation process.
 // Utilize Element->debug_id to set readable names for your elements.
 // #define RECOMPUI_NAV_DEBUG
@@ -13,49 +17,99 @@
 static int doc_counter = 0;
 
 namespace recompui {
-    // struct for helping with rml element position comparisons.
-    // GetAbsoluteOffset has some overhead so calculating this once per element is ideal.
-    struct RmlPosSize {
-        Rml::Vector2f position;
-        Rml::Vector2f bottom_right;
-    
-        RmlPosSize(Rml::Element *element) {
-            position = element->GetAbsoluteOffset();
-            bottom_right = position + element->GetBox().GetSize();
-        }
-    
-        float get_distance_axis(const RmlPosSize& other, bool horizontal) const {
-            if (horizontal) {
-                float dx_1 = std::abs(position.x - other.bottom_right.x);
-                float dx_2 = std::abs(bottom_right.x - other.position.x);
-                return std::min(dx_1, dx_2);
-            } else {
-                float dy_1 = std::abs(position.y - other.bottom_right.y);
-                float dy_2 = std::abs(bottom_right.y - other.position.y);
-                return std::min(dy_1, dy_2);
+    NavSpatialIndex::NavSpatialIndex(const std::vector<Element *> &elements, std::vector<RmlPosSize> &&boxes) :
+        elements(elements), boxes(std::move(boxes))
+    {
+        assert(this->elements.size() == this->boxes.size());
+
+        std::vector<uint32_t> indices(this->elements.size());
+        for (uint32_t i = 0; i < indices.size(); i++) {
+            indices[i] = i;
+        }
+
+        // Stable sorts keep elements with the same edge in their original order, which is used for tie breaking.
+        const std::vector<RmlPosSize> &b = this->boxes;
+        by_top = indices;
+        std::stable_sort(by_top.begin(), by_top.end(), [&b](uint32_t lhs, uint32_t rhs) { return b[lhs].position.y < b[rhs].position.y; });
+        by_bottom = indices;
+        std::stable_sort(by_bottom.begin(), by_bottom.end(), [&b](uint32_t lhs, uint32_t rhs) { return b[lhs].bottom_right.y > b[rhs].bottom_right.y; });
+        by_left = indices;
+        std::stable_sort(by_left.begin(), by_left.end(), [&b](uint32_t lhs, uint32_t rhs) { return b[lhs].position.x < b[rhs].position.x; });
+        by_right = indices;
+        std::stable_sort(by_right.begin(), by_right.end(), [&b](uint32_t lhs, uint32_t rhs) { return b[lhs].bottom_right.x > b[rhs].bottom_right.x; });
+    }
+
+    Element *NavSpatialIndex::find_in_direction(Element *from, const RmlPosSize &from_pos_size, NavDirection dir) const {
+        const std::vector<uint32_t> *order = nullptr;
+        switch (dir) {
+            case NavDirection::Up:    order = &by_bottom; break;
+            case NavDirection::Down:  order = &by_top;    break;
+            case NavDirection::Left:  order = &by_right;  break;
+            case NavDirection::Right: order = &by_left;   break;
+        }
+        if (order == nullptr) {
+            return nullptr;
+        }
+
+        // Each order is sorted so that the elements in the given direction form a suffix, ordered by increasing
+        // distance along the navigation axis. Skip to the start of that suffix.
+        auto first = std::partition_point(order->begin(), order->end(), [&](uint32_t index) {
+            return !from_pos_size.can_navigate_to_using_direction(boxes[index], dir);
+        });
+
+        bool horizontal = dir == NavDirection::Left || dir == NavDirection::Right;
+        Element *closest = nullptr;
+        uint32_t closest_index = 0;
+        float closest_distance = std::numeric_limits<float>::max();
+        float closest_distance_other_axis = std::numeric_limits<float>::max();
+
+        // Only the elements that share the smallest distance need to be checked, as they're the only possible results.
+        for (auto it = first; it != order->end(); ++it) {
+            uint32_t index = *it;
+            if (elements[index] == from) {
+                continue;
+            }
+
+            float distance = from_pos_size.get_distance_axis(boxes[index], horizontal);
+            if (closest != nullptr && distance > closest_distance) {
+                break;
+            }
+
+            float other_axis_distance = from_pos_size.get_distance_axis(boxes[index], !horizontal);
+            if (
+                closest == nullptr ||
+                other_axis_distance < closest_distance_other_axis ||
+                (other_axis_distance == closest_distance_other_axis && index < closest_index)
+            ) {
+                closest = elements[index];
+                closest_index = index;
+                closest_distance = distance;
+                closest_distance_other_axis = other_axis_distance;
             }
         }
-    
-        float get_distance(const RmlPosSize& other) const {
-            return std::min(get_distance_axis(other, true), get_distance_axis(other, false));
-        }
-    
-        bool can_navigate_to_using_direction(const RmlPosSize& other, NavDirection dir) const {
-            switch (dir) {
-                case NavDirection::Up:    return is_below(other);
-                case NavDirection::Down:  return is_above(other);
-                case NavDirection::Left:  return is_right_of(other);
-                case NavDirection::Right: return is_left_of(other);
+
+        return closest;
+    }
+
+    Element *NavSpatialIndex::find_closest(Element *from, const RmlPosSize &from_pos_size) const {
+        // The distance used here mixes both edges of both axes, so it doesn't map onto a single sorted order.
+        // This is still a linear search, but it works on cached boxes instead of querying RmlUi for every element.
+        Element *closest = nullptr;
+        float closest_distance = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < elements.size(); i++) {
+            if (elements[i] == from) {
+                continue;
+            }
+
+            float distance = from_pos_size.get_distance(boxes[i]);
+            if (distance < closest_distance) {
+                closest_distance = distance;
+                closest = elements[i];
             }
-            return false;
         }
-    
-        // The following 4 funcs return true if this element is completely on one side of the other, not overlapping.
-        bool is_left_of(const RmlPosSize& other) const  { return bottom_right.x <= other.position.x; }
-        bool is_right_of(const RmlPosSize& other) const { return position.x >= other.bottom_right.x; }
-        bool is_above(const RmlPosSize& other) const    { return bottom_right.y <= other.position.y; }
-        bool is_below(const RmlPosSize& other) const    { return position.y >= other.bottom_right.y; }
-    };
+
+        return closest;
+    }
 
     static NavigationType get_effective_nav_type(NavigationType nav_type) {
         switch (nav_type) {
@@ -90,8 +144,9 @@ namespace recompui {
         // In this case, only used to represent whether navigating vertically or horizontally.
         NavigationType nav_dir_type;
         NavDirection nav_direction;
+        Document *doc;
 
-        RecompNav(Document *doc, int key_identifier) {
+        RecompNav(Document *doc, int key_identifier) : doc(doc) {
             switch (key_identifier) {
                 case Rml::Input::KI_UP:    nav_dir_value = -1; nav_dir_type = NavigationType::Vertical;   nav_direction = NavDirection::Up;    break;
                 case Rml::Input::KI_DOWN:  nav_dir_value =  1; nav_dir_type = NavigationType::Vertical;   nav_direction = NavDirection::Down;  break;
@@ -100,9 +155,7 @@ namespace recompui {
             }
             auto ctx = get_current_context();
             original_focused_element = ctx.get_focused_element();
-            // Reset and rebuild navigation tree.
-            doc->nav_children.clear();
-            doc->build_navigation(doc, original_focused_element);
+            doc->update_navigation(original_focused_element);
         };
 
         #ifdef RECOMPUI_NAV_DEBUG
@@ -114,12 +167,11 @@ namespace recompui {
                 indent += indent_str;
                 cur = cur->get_nav_parent();
             }
-            std::string id = el->debug_id.empty() ? el->id : el->debug_id;
-            std::cout << indent << id << "\n";
+            std::cout << indent << el->get_debug_id_or_id() << "\n";
         }
         #endif
 
-        static int get_element_index(Element *el, std::vector<Element *> elements) {
+        static int get_element_index(Element *el, const std::vector<Element *> &elements) {
             for (int i = 0; i < static_cast<int>(elements.size()); i++) {
                 if (el == elements[i]) {
                     return i;
@@ -135,51 +187,19 @@ namespace recompui {
             return elements[index];
         }
 
-        // Use nav_direction to filter elements that match that direction, then pick the closest.
-        Element *get_element_in_nav_direction(Element *this_element, std::vector<Element *> &elements) {
-            if (elements.empty()) {
+        // Use nav_direction to filter the nav container's children that match that direction, then pick the closest.
+        Element *get_element_in_nav_direction(Element *this_element, Element *nav_container) {
+            if (nav_container->nav_children.empty()) {
                 return nullptr;
             }
 
             // Should this be original_focused_element?
-            RmlPosSize this_pos_size(this_element->base);
+            RmlPosSize this_pos_size(this_element->get_geometry());
 
             // Alternative idea: compare distances/directions from the original focused element, instead of where we have unwrapped to.
-            // RmlPosSize this_pos_size(original_focused_element->base);
-
-            std::vector<std::pair<Element *, RmlPosSize>> elements_in_direction;
-            for (auto &element : elements) {
-                if (element == this_element) {
-                    continue;
-                }
-                auto element_box = element->base->GetBox();
-                RmlPosSize element_pos_size(element->base);
-                if (this_pos_size.can_navigate_to_using_direction(element_pos_size, nav_direction)) {
-                    elements_in_direction.emplace_back(element, element_pos_size);
-                }
-            }
-            
-            Element *closest = nullptr;
-            float closest_distance = std::numeric_limits<float>::max();
-            float closest_distance_other_axis = std::numeric_limits<float>::max();
-
-            for (auto &[element, element_pos_size] : elements_in_direction) {
-                float distance = this_pos_size.get_distance_axis(element_pos_size, nav_dir_type == NavigationType::Horizontal);
-                if (distance < closest_distance) {
-                    closest_distance = distance;
-                    closest = element;
-                    closest_distance_other_axis = this_pos_size.get_distance_axis(element_pos_size, nav_dir_type != NavigationType::Horizontal);
-                } else if (distance == closest_distance) {
-                    float other_axis_distance = this_pos_size.get_distance_axis(element_pos_size, nav_dir_type != NavigationType::Horizontal);
-                    if (other_axis_distance < closest_distance_other_axis) {
-                        closest_distance_other_axis = other_axis_distance;
-                        closest_distance = distance;
-                        closest = element;
-                    }
-                }
-            }
+            // RmlPosSize this_pos_size(original_focused_element->get_geometry());
 
-            return closest;
+            return doc->get_nav_spatial_index(nav_container).find_in_direction(this_element, this_pos_size, nav_direction);
         }
 
         // Try to navigate in the given direction, and if it isn't possible then try from the element's nav parent.
@@ -247,7 +267,7 @@ namespace recompui {
             }
 
             if (nav_parent->nav_type == NavigationType::Auto) {
-                auto next_element = get_element_in_nav_direction(this_element, nav_parent->nav_children);
+                auto next_element = get_element_in_nav_direction(this_element, nav_parent);
                 if (next_element != nullptr) {
                     return next_element;
                 }
@@ -256,28 +276,13 @@ namespace recompui {
             return unwind_nav_in_direction(nav_parent);
         }
 
-        static Element *get_closest_element(Element *this_element, std::vector<Element *> &elements) {
-            if (elements.empty()) {
+        Element *get_closest_element(Element *this_element, Element *nav_container) {
+            if (nav_container->nav_children.empty()) {
                 return nullptr;
             }
 
-            RmlPosSize this_pos_size(this_element->base);
-            Element *closest = nullptr;
-            float closest_distance = std::numeric_limits<float>::max();
-            for (auto &element : elements) {
-                if (element == this_element) {
-                    continue;
-                }
-
-                RmlPosSize element_pos_size(element->base);
-                float distance = this_pos_size.get_distance(element_pos_size);
-                if (distance < closest_distance) {
-                    closest_distance = distance;
-                    closest = element;
-                }
-            }
-
-            return closest;
+            RmlPosSize this_pos_size(this_element->get_geometry());
+            return doc->get_nav_spatial_index(nav_container).find_closest(this_element, this_pos_size);
         }
 
         // Using the result of unwind_nav_in_direction, navigate through nav children until finding an element without children.
@@ -308,7 +313,7 @@ namespace recompui {
                     }
                 }
 
-                return dive_nav_from_direction(get_closest_element(original_focused_element, this_element->nav_children));
+                return dive_nav_from_direction(get_closest_element(original_focused_element, this_element));
             }
         }
     };
@@ -330,6 +335,128 @@ namespace recompui {
                 recompui::EventType::Focus));
     }
 
+    // Every RmlUi event that recompui elements can listen to.
+    static const Rml::EventId routed_event_ids[] = {
+        Rml::EventId::Click,
+        Rml::EventId::Mousedown,
+        Rml::EventId::Mouseup,
+        Rml::EventId::Focus,
+        Rml::EventId::Blur,
+        Rml::EventId::Mouseover,
+        Rml::EventId::Mouseout,
+        Rml::EventId::Drag,
+        Rml::EventId::Dragstart,
+        Rml::EventId::Dragend,
+        Rml::EventId::Change,
+        Rml::EventId::Keydown,
+        // Not delivered to elements, but scrolling moves elements without a layout pass so it invalidates cached geometry.
+        Rml::EventId::Scroll,
+    };
+
+    void DocumentEventRouter::ProcessEvent(Rml::Event &event) {
+        doc->route_event(event, capture);
+    }
+
+    void Document::attach_event_routers() {
+        if (event_routers_attached) {
+            return;
+        }
+
+        for (Rml::EventId event_id : routed_event_ids) {
+            base->AddEventListener(event_id, &capture_router, true);
+            base->AddEventListener(event_id, &bubble_router, false);
+        }
+
+        event_routers_attached = true;
+    }
+
+    void Document::detach_event_routers() {
+        if (!event_routers_attached) {
+            return;
+        }
+
+        for (Rml::EventId event_id : routed_event_ids) {
+            base->RemoveEventListener(event_id, &capture_router, true);
+            base->RemoveEventListener(event_id, &bubble_router, false);
+        }
+
+        event_routers_attached = false;
+    }
+
+    Element *Document::get_event_element(Rml::Element *element) {
+        if (element == base) {
+            return this;
+        }
+
+        return owning_context.get_element_from_base(element);
+    }
+
+    void Document::route_event(Rml::Event &event, bool capture) {
+        Rml::Element *target = event.GetTargetElement();
+        if (target == nullptr) {
+            return;
+        }
+
+        // Capture listeners also run during the target phase when the document itself is the target.
+        if (capture == (event.GetPhase() == Rml::EventPhase::Bubble)) {
+            return;
+        }
+
+        EventContextScope context_scope{ owning_context };
+
+        if (capture) {
+            switch (event.GetId()) {
+                case Rml::EventId::Scroll:
+                    owning_context.invalidate_layout();
+                    break;
+                // RmlUi changes these elements on its own, through pseudo-classes and edited text, which can affect layout.
+                case Rml::EventId::Mouseover:
+                case Rml::EventId::Mouseout:
+                case Rml::EventId::Focus:
+                case Rml::EventId::Blur:
+                case Rml::EventId::Change:
+                    owning_context.mark_layout_dirty();
+                    break;
+                default:
+                    break;
+            }
+
+            // Deliver the event to its target before RmlUi's own target listeners run, so elements still receive
+            // events that those listeners stop from propagating.
+            Element *element = get_event_element(target);
+            if (element != nullptr && element->handles_rml_event(event.GetId())) {
+                element->process_rml_event(event, true);
+            }
+            return;
+        }
+
+        // Collect the ancestors first, as handling the event may modify the element tree.
+        Rml::Element *cur_parent = target->GetParentNode();
+        std::vector<Rml::ObserverPtr<Rml::Element>> ancestors;
+        while (cur_parent != nullptr) {
+            ancestors.emplace_back(cur_parent->GetObserverPtr());
+            if (cur_parent == base) {
+                break;
+            }
+            cur_parent = cur_parent->GetParentNode();
+        }
+
+        for (const Rml::ObserverPtr<Rml::Element> &ancestor : ancestors) {
+            if (!event.IsPropagating()) {
+                break;
+            }
+
+            if (!ancestor) {
+                continue;
+            }
+
+            Element *element = get_event_element(ancestor.get());
+            if (element != nullptr && element->handles_rml_event(event.GetId())) {
+                element->process_rml_event(event, false);
+            }
+        }
+    }
+
     void Document::process_event(const Event &e) {
         switch (e.type) {
             case recompui::EventType::Update: {
@@ -361,6 +488,11 @@ namespace recompui {
     }
 
     void Document::report_removed_element(Element* element) {
+        if (navigation_forced_focus == element) {
+            navigation_forced_focus = nullptr;
+            navigation_built_generation = 0;
+        }
+
         if (last_focused == element) {
             last_focused = nullptr;
         }
@@ -370,6 +502,79 @@ namespace recompui {
         }
     }
 
+    bool Document::is_navigation_valid(Element *focused_element) {
+        if (navigation_built_generation != owning_context.get_navigation_generation()) {
+            return false;
+        }
+
+        if (navigation_forced_focus != nullptr && navigation_forced_focus != focused_element) {
+            return false;
+        }
+
+        // Changes that come from RmlUi directly, like a stylesheet hiding an element, aren't tracked by the generation.
+        // Make sure the chain from the focused element up to the document is still intact so navigating from it can't fail.
+        Element *cur = focused_element;
+        while (cur != nullptr && cur != this) {
+            Element *nav_parent = cur->get_nav_parent();
+            if (nav_parent == nullptr) {
+                return false;
+            }
+
+            const std::vector<Element *> &siblings = nav_parent->nav_children;
+            if (std::find(siblings.begin(), siblings.end(), cur) == siblings.end()) {
+                return false;
+            }
+
+            cur = nav_parent;
+        }
+
+        return true;
+    }
+
+    const NavSpatialIndex &Document::get_nav_spatial_index(Element *nav_container) {
+        // Element positions are only valid for the layout they were read from.
+        uint32_t layout_generation = owning_context.get_layout_generation();
+        if (nav_spatial_layout_generation != layout_generation) {
+            nav_spatial_indices.clear();
+            nav_spatial_layout_generation = layout_generation;
+        }
+
+        auto find_it = nav_spatial_indices.find(nav_container);
+        if (find_it != nav_spatial_indices.end()) {
+            return find_it->second;
+        }
+
+        std::vector<RmlPosSize> boxes;
+        boxes.reserve(nav_container->nav_children.size());
+        for (Element *child : nav_container->nav_children) {
+            boxes.emplace_back(child->get_geometry());
+        }
+
+        navigation_stats.spatial_index_builds++;
+        auto emplace_result = nav_spatial_indices.emplace(nav_container, NavSpatialIndex{ nav_container->nav_children, std::move(boxes) });
+        return emplace_result.first->second;
+    }
+
+    void Document::update_navigation(Element *focused_element) {
+        if (is_navigation_valid(focused_element)) {
+            return;
+        }
+
+        // Reset and rebuild navigation tree.
+        navigation_stats.tree_rebuilds++;
+        nav_children.clear();
+        build_navigation(this, focused_element);
+        nav_spatial_indices.clear();
+
+        navigation_built_generation = owning_context.get_navigation_generation();
+        if (focused_element != nullptr && focused_element->is_focusable() != CanFocus::Yes) {
+            navigation_forced_focus = focused_element;
+        }
+        else {
+            navigation_forced_focus = nullptr;
+        }
+    }
+
     bool Document::handle_navigation_event(Rml::Event &event) {
         if (
             event.GetId() == Rml::EventId::Keydown &&
@@ -386,47 +591,67 @@ namespace recompui {
                 return false;
             }
 
-            RecompNav nav_context(this, key_identifier);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bool handled = navigate(event, key_identifier);
+            std::chrono::nanoseconds move_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
 
-            if (nav_context.original_focused_element == nullptr) {
-                return false;
+            navigation_stats.moves++;
+            if (!handled) {
+                navigation_stats.failed_moves++;
             }
+            navigation_stats.last_move_time = move_time;
+            navigation_stats.max_move_time = std::max(navigation_stats.max_move_time, move_time);
+            navigation_stats.total_move_time += move_time;
 
             #ifdef RECOMPUI_NAV_DEBUG
-            std::cout << "\nNAV START\n";
+            std::cout << "NAV TIME: " << std::chrono::duration<double, std::micro>(move_time).count() << " us\n";
             #endif
 
-            Element *next_top_element = nav_context.unwind_nav_in_direction(nav_context.original_focused_element);
-            if (next_top_element == nullptr) {
-                return false;
-            }
+            return handled;
+        } else {
+            return false;
+        }
+    }
 
-            #ifdef RECOMPUI_NAV_DEBUG
-            nav_context.print_debug_id(next_top_element, "→ ");
-            #endif
+    bool Document::navigate(Rml::Event &event, int key_identifier) {
+        RecompNav nav_context(this, key_identifier);
 
-            Element *doc_as_element = static_cast<Element *>(this);
-            if (doc_as_element == next_top_element) {
-                event.StopPropagation();
-                return true;
-            }
+        if (nav_context.original_focused_element == nullptr) {
+            return false;
+        }
 
-            Element *next_bottom_element = nav_context.dive_nav_from_direction(next_top_element);
-            if (next_bottom_element == nullptr) {
-                return false;
-            }
+        #ifdef RECOMPUI_NAV_DEBUG
+        std::cout << "\nNAV START\n";
+        #endif
 
-            #ifdef RECOMPUI_NAV_DEBUG
-            nav_context.print_debug_id(next_bottom_element, "→ ");
-            #endif
+        Element *next_top_element = nav_context.unwind_nav_in_direction(nav_context.original_focused_element);
+        if (next_top_element == nullptr) {
+            return false;
+        }
 
-            event.StopPropagation();
-            next_bottom_element->focus();
-            report_focused_element();
+        #ifdef RECOMPUI_NAV_DEBUG
+        nav_context.print_debug_id(next_top_element, "→ ");
+        #endif
 
+        Element *doc_as_element = static_cast<Element *>(this);
+        if (doc_as_element == next_top_element) {
+            event.StopPropagation();
             return true;
-        } else {
+        }
+
+        Element *next_bottom_element = nav_context.dive_nav_from_direction(next_top_element);
+        if (next_bottom_element == nullptr) {
             return false;
         }
+
+        #ifdef RECOMPUI_NAV_DEBUG
+        nav_context.print_debug_id(next_bottom_element, "→ ");
+        #endif
+
+        event.StopPropagation();
+        next_bottom_element->focus();
+        report_focused_element();
+
+        return true;
     }
 } // namespace recompui
@@ -2,12 +2,115 @@
 #include "core/ui_context.h"
 #include "elements/ui_element.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+
 namespace recompui {
     class Element;
     class ContextId;
 
+    // struct for helping with rml element position comparisons.
+    // GetAbsoluteOffset has some overhead so calculating this once per element is ideal.
+    struct RmlPosSize {
+        Rml::Vector2f position;
+        Rml::Vector2f bottom_right;
+    
+        RmlPosSize(Rml::Element *element) {
+            position = element->GetAbsoluteOffset();
+            bottom_right = position + element->GetBox().GetSize();
+        }
+
+        RmlPosSize(const ElementGeometry &geometry) {
+            position = geometry.absolute_offset;
+            bottom_right = position + geometry.box_size;
+        }
+    
+        float get_distance_axis(const RmlPosSize& other, bool horizontal) const {
+            if (horizontal) {
+                float dx_1 = std::abs(position.x - other.bottom_right.x);
+                float dx_2 = std::abs(bottom_right.x - other.position.x);
+                return std::min(dx_1, dx_2);
+            } else {
+                float dy_1 = std::abs(position.y - other.bottom_right.y);
+                float dy_2 = std::abs(bottom_right.y - other.position.y);
+                return std::min(dy_1, dy_2);
+            }
+        }
+    
+        float get_distance(const RmlPosSize& other) const {
+            return std::min(get_distance_axis(other, true), get_distance_axis(other, false));
+        }
+    
+        bool can_navigate_to_using_direction(const RmlPosSize& other, NavDirection dir) const {
+            switch (dir) {
+                case NavDirection::Up:    return is_below(other);
+                case NavDirection::Down:  return is_above(other);
+                case NavDirection::Left:  return is_right_of(other);
+                case NavDirection::Right: return is_left_of(other);
+            }
+            return false;
+        }
+    
+        // The following 4 funcs return true if this element is completely on one side of the other, not overlapping.
+        bool is_left_of(const RmlPosSize& other) const  { return bottom_right.x <= other.position.x; }
+        bool is_right_of(const RmlPosSize& other) const { return position.x >= other.bottom_right.x; }
+        bool is_above(const RmlPosSize& other) const    { return bottom_right.y <= other.position.y; }
+        bool is_below(const RmlPosSize& other) const    { return position.y >= other.bottom_right.y; }
+    };
+
+    // Boxes of a navigation container's children, sorted along each edge so the nearest element in a direction can be
+    // found with a binary search instead of checking every child. Built lazily and only valid for one layout generation.
+    class NavSpatialIndex {
+    public:
+        NavSpatialIndex(const std::vector<Element *> &elements, std::vector<RmlPosSize> &&boxes);
+        // Same result as checking every element with RmlPosSize::can_navigate_to_using_direction and picking the
+        // one with the smallest distance along the navigation axis, using the other axis to break ties.
+        Element *find_in_direction(Element *from, const RmlPosSize &from_pos_size, NavDirection dir) const;
+        // Picks the element with the smallest RmlPosSize::get_distance to the given box.
+        Element *find_closest(Element *from, const RmlPosSize &from_pos_size) const;
+    private:
+        std::vector<Element *> elements;
+        std::vector<RmlPosSize> boxes;
+        // Element indices sorted by top edge (ascending), bottom edge (descending), left edge (ascending) and right edge (descending).
+        std::vector<uint32_t> by_top;
+        std::vector<uint32_t> by_bottom;
+        std::vector<uint32_t> by_left;
+        std::vector<uint32_t> by_right;
+    };
+
+    class Document;
+
+    // Counters for a document's directional navigation, for finding regressions that users would notice as controller lag.
+    struct NavigationStats {
+        // Directional inputs that were handled by the document, and how many of those didn't find an element to focus.
+        uint32_t moves = 0;
+        uint32_t failed_moves = 0;
+        uint32_t tree_rebuilds = 0;
+        uint32_t spatial_index_builds = 0;
+        // Time spent handling directional inputs, including rebuilding the navigation tree.
+        std::chrono::nanoseconds last_move_time{};
+        std::chrono::nanoseconds max_move_time{};
+        std::chrono::nanoseconds total_move_time{};
+    };
+
+    // Listener registered once on the RmlUi document that forwards events to the recompui elements they're meant for.
+    // The capture router delivers events to their target and the bubble router delivers them to the target's ancestors.
+    // This means targets see events before any other listener below the document, and ancestors see them after every
+    // other bubble listener, so a plain RmlUi listener that stops propagation hides the event from all recompui ancestors.
+    class DocumentEventRouter : public Rml::EventListener {
+    public:
+        DocumentEventRouter(Document *doc, bool capture) : doc(doc), capture(capture) {}
+        void ProcessEvent(Rml::Event &event) override;
+    private:
+        Document *doc;
+        bool capture;
+    };
+
     class Document : public Element {
     friend class ContextId;
+    friend class RecompNav;
     protected:
         std::string_view get_type_name() override { return "Document"; }
         void process_event(const Event &e) override;
@@ -21,8 +124,33 @@ namespace recompui {
         void report_removed_element(Element* element);
         Element* get_last_focused_element() { return last_focused; }
         Element* get_last_focusable_hovered_element() { return last_focusable_hovered; }
+        // Registers the event routers on the RmlUi document. Must be called once the document's base element is final.
+        void attach_event_routers();
+        // Removes the event routers from the RmlUi document, which outlives the context.
+        void detach_event_routers();
+        void route_event(Rml::Event &event, bool capture);
+        const NavigationStats &get_navigation_stats() const { return navigation_stats; }
+        void reset_navigation_stats() { navigation_stats = {}; }
     private:
+        NavigationStats navigation_stats;
+        bool navigate(Rml::Event &event, int key_identifier);
+        DocumentEventRouter capture_router{ this, true };
+        DocumentEventRouter bubble_router{ this, false };
+        bool event_routers_attached = false;
+        Element *get_event_element(Rml::Element *element);
         virtual bool handle_navigation_event(Rml::Event &event) override;
+        // Rebuilds the navigation tree if anything that affects it has changed since it was last built.
+        void update_navigation(Element *focused_element);
+        bool is_navigation_valid(Element *focused_element);
+        // Navigation generation that the cached navigation tree was built at, or 0 if it hasn't been built.
+        uint32_t navigation_built_generation = 0;
+        // The focused element is always added to the navigation tree when building it. If it wouldn't have been
+        // added otherwise, the tree is only valid while that element is focused.
+        Element *navigation_forced_focus = nullptr;
+        // Spatial indices for navigation containers, built on demand. Cleared when the layout or navigation tree changes.
+        std::unordered_map<Element *, NavSpatialIndex> nav_spatial_indices;
+        uint32_t nav_spatial_layout_generation = 0;
+        const NavSpatialIndex &get_nav_spatial_index(Element *nav_container);
         Element *last_focused = nullptr;
         Element *last_focusable_hovered = nullptr;
         bool update_last_focused = false;
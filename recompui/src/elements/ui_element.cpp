@@ -9,6 +9,43 @@
 
 namespace recompui {
 
+void Element::invalidate_navigation() {
+    // Shims are owned by the context itself, and contexts are torn down with no context open. Neither has a
+    // navigation tree left to invalidate.
+    ContextId current_context = try_get_current_context();
+    if (shim || current_context == ContextId::null()) {
+        return;
+    }
+
+    // Elements don't have an owning context yet while they're being constructed, which only happens with their context open.
+    ContextId context = owning_context != ContextId::null() ? owning_context : current_context;
+    context.invalidate_navigation();
+}
+
+void Element::mark_layout_dirty() {
+    // Skipped for the same reasons as invalidate_navigation.
+    ContextId current_context = try_get_current_context();
+    if (shim || current_context == ContextId::null()) {
+        return;
+    }
+
+    ContextId context = owning_context != ContextId::null() ? owning_context : current_context;
+    context.mark_layout_dirty();
+}
+
+// Properties that change whether an element is visible or focusable, and therefore its place in the navigation tree.
+static bool property_affects_navigation(Rml::PropertyId property_id) {
+    switch (property_id) {
+        case Rml::PropertyId::Display:
+        case Rml::PropertyId::Visibility:
+        case Rml::PropertyId::Focus:
+        case Rml::PropertyId::TabIndex:
+            return true;
+        default:
+            return false;
+    }
+}
+
 Element::Element(ResourceId rid, Rml::Element *base) : Style(rid) {
     assert(resource_id != ResourceId::null());
     assert(base != nullptr);
@@ -27,6 +64,7 @@ Element::Element(ResourceId rid, Element* parent, uint32_t events_enabled, Rml::
         base = parent->base->AppendChild(std::move(base_owning));
         parent->add_child(this);
         this->parent = parent;
+        mark_layout_dirty();
     }
     else {
         base = base_owning.get();
@@ -39,6 +77,8 @@ Element::Element(ResourceId rid, Element* parent, uint32_t events_enabled, Rml::
 }
 
 Element::~Element() {
+    invalidate_navigation();
+    mark_layout_dirty();
     if (!shim) {
         clear_children();
         if (!base_owning) {
@@ -63,6 +103,8 @@ void Element::add_child(Element *child) {
 }
 
 void Element::set_parent(Element *new_parent) {
+    invalidate_navigation();
+    mark_layout_dirty();
     if (parent != nullptr) {
         parent->remove_child(this, false);
         base_owning = parent->base->RemoveChild(base);
@@ -72,53 +114,76 @@ void Element::set_parent(Element *new_parent) {
         base = parent->base->AppendChild(std::move(base_owning), true);
         parent->add_child(this);
     }
+    else if (base_owning) {
+        // Detached element, so its whole subtree can be moved into the new parent with a single append.
+        ContextId context = get_current_context();
+        context.remove_loose_element(this);
+
+        parent = new_parent;
 
+        base = parent->base->AppendChild(std::move(base_owning), true);
+        parent->add_child(this);
+    }
 }
 
 void Element::set_property(Rml::PropertyId property_id, const Rml::Property &property) {
     assert(base != nullptr);
 
+    if (property_affects_navigation(property_id)) {
+        invalidate_navigation();
+    }
+
     base->SetProperty(property_id, property);
+    mark_layout_dirty();
     Style::set_property(property_id, property);
 }
 
 void Element::register_event_listeners(uint32_t events_enabled) {
     assert(base != nullptr);
 
+    // Events are delivered by the document's event router, which checks this mask. See Document::route_event.
     this->events_enabled = events_enabled;
+}
 
-    if (events_enabled & Events(EventType::Click)) {
-        base->AddEventListener(Rml::EventId::Click, this);
-    }
-
-    if (events_enabled & Events(EventType::MouseButton)) {
-        base->AddEventListener(Rml::EventId::Mousedown, this);
-        base->AddEventListener(Rml::EventId::Mouseup, this);
-    }
-
-    if (events_enabled & Events(EventType::Focus)) {
-        base->AddEventListener(Rml::EventId::Focus, this);
-        base->AddEventListener(Rml::EventId::Blur, this);
-    }
-
-    if (events_enabled & Events(EventType::Hover)) {
-        base->AddEventListener(Rml::EventId::Mouseover, this);
-        base->AddEventListener(Rml::EventId::Mouseout, this);
+// Gets the events that need to be enabled on an element for it to handle the given RmlUi event.
+static uint32_t get_rml_event_mask(Rml::EventId event_id) {
+    switch (event_id) {
+        case Rml::EventId::Click:
+            return Events(EventType::Click);
+        case Rml::EventId::Mousedown:
+        case Rml::EventId::Mouseup:
+            return Events(EventType::MouseButton);
+        case Rml::EventId::Focus:
+        case Rml::EventId::Blur:
+            return Events(EventType::Focus);
+        case Rml::EventId::Mouseover:
+        case Rml::EventId::Mouseout:
+            return Events(EventType::Hover);
+        case Rml::EventId::Drag:
+        case Rml::EventId::Dragstart:
+        case Rml::EventId::Dragend:
+            return Events(EventType::Drag);
+        case Rml::EventId::Change:
+            return Events(EventType::Text);
+        case Rml::EventId::Keydown:
+            return Events(EventType::Navigate, EventType::MenuAction);
+        default:
+            return 0;
     }
+}
 
-    if (events_enabled & Events(EventType::Drag)) {
-        base->AddEventListener(Rml::EventId::Drag, this);
-        base->AddEventListener(Rml::EventId::Dragstart, this);
-        base->AddEventListener(Rml::EventId::Dragend, this);
-    }
+bool Element::handles_rml_event(Rml::EventId event_id) const {
+    return (events_enabled & get_rml_event_mask(event_id)) != 0;
+}
 
-    if (events_enabled & Events(EventType::Text)) {
-        base->AddEventListener(Rml::EventId::Change, this);
-    }
+void Element::add_rml_event_listener(Rml::EventId event_id, Rml::EventListener *listener, bool in_capture) {
+    assert(base != nullptr);
+    base->AddEventListener(event_id, listener, in_capture);
+}
 
-    if (events_enabled & Events(EventType::Navigate, EventType::MenuAction)) {
-        base->AddEventListener(Rml::EventId::Keydown, this);
-    }
+void Element::remove_rml_event_listener(Rml::EventId event_id, Rml::EventListener *listener, bool in_capture) {
+    assert(base != nullptr);
+    base->RemoveEventListener(event_id, listener, in_capture);
 }
 
 void Element::apply_style(Style *style) {
@@ -127,13 +192,21 @@ void Element::apply_style(Style *style) {
         // This avoids expensive layout operations when a simple color-only style is applied.
         const Rml::Property* cur_value = base->GetLocalProperty(it.first);
         if (cur_value == nullptr || *cur_value != it.second) {
+            if (property_affects_navigation(it.first)) {
+                invalidate_navigation();
+            }
             base->SetProperty(it.first, it.second);
+            mark_layout_dirty();
         }
     }
 }
 
 void Element::remove_property(Rml::PropertyId property_id) {
+    if (property_affects_navigation(property_id)) {
+        invalidate_navigation();
+    }
     base->RemoveProperty(property_id);
+    mark_layout_dirty();
     if (property_map.find(property_id) != property_map.end()) {
         property_map.erase(property_id);
     }
@@ -154,12 +227,14 @@ void Element::propagate_disabled(bool disabled) {
 
     bool attribute_state = disabled_from_parent || !enabled;
     if (disabled_attribute != attribute_state) {
+        invalidate_navigation();
         disabled_attribute = attribute_state;
         if (disabled_attribute) {
             base->SetAttribute("disabled", true);
         } else {
             base->RemoveAttribute("disabled");
         }
+        mark_layout_dirty();
 
         if (events_enabled & Events(EventType::Enable)) {
             handle_event(Event::enable_event(!attribute_state));
@@ -184,6 +259,13 @@ void Element::set_id(const std::string& new_id) {
     base->SetId(new_id);
 }
 
+const std::string& Element::get_id() {
+    if (id.empty()) {
+        set_id(std::string{ get_type_name() } + "-" + std::to_string(resource_id.slot_id));
+    }
+    return id;
+}
+
 recompui::MouseButton convert_rml_mouse_button(int button) {
     switch (button) {
         case 0:
@@ -197,21 +279,46 @@ recompui::MouseButton convert_rml_mouse_button(int button) {
     }
 }
 
-void Element::ProcessEvent(Rml::Event &event) {
-    ContextId prev_context = recompui::try_close_current_context();
-    ContextId context = ContextId::null();
-    Rml::ElementDocument* doc = event.GetTargetElement()->GetOwnerDocument();
-    if (doc != nullptr) {
-        context = get_context_from_document(doc);
+EventContextScope::EventContextScope(ContextId context) : context(context) {
+    // If an event dispatch batch is already holding this context open, keep using it as-is.
+    was_held = context != ContextId::null() && context.is_held_for_event_dispatch();
+    if (!was_held) {
+        prev_context = recompui::try_close_current_context();
     }
 
-    bool did_open = false;
-
     // TODO disallow null contexts once the entire UI system has been migrated.
     if (context != ContextId::null()) {
         did_open = context.open_if_not_already();
     }
+}
+
+EventContextScope::~EventContextScope() {
+    // Leave the context open for the next event if a dispatch batch is active and no other context needs to be restored.
+    if (context != ContextId::null() && (did_open || was_held)) {
+        if (prev_context != ContextId::null() || !context.hold_for_event_dispatch()) {
+            context.close();
+        }
+    }
+
+    if (prev_context != ContextId::null()) {
+        prev_context.open();
+    }
+}
+
+void Element::ProcessEvent(Rml::Event &event) {
+    ContextId context = owning_context;
+    if (context == ContextId::null()) {
+        Rml::ElementDocument* doc = event.GetTargetElement()->GetOwnerDocument();
+        if (doc != nullptr) {
+            context = get_context_from_document(doc);
+        }
+    }
+
+    EventContextScope context_scope{ context };
+    process_rml_event(event, event.GetPhase() == Rml::EventPhase::Target);
+}
 
+void Element::process_rml_event(Rml::Event &event, bool is_target) {
     // Events that are processed during any phase.
     switch (event.GetId()) {
     case Rml::EventId::Click:
@@ -273,8 +380,9 @@ void Element::ProcessEvent(Rml::Event &event) {
         break;
     }
 
-    // Events that are only processed during the Target phase.
-    if (event.GetPhase() == Rml::EventPhase::Target) {
+    // Events that are only processed when this element is the target.
+    if (is_target) {
+        ContextId context = get_current_context();
         switch (event.GetId()) {
         case Rml::EventId::Mouseover:
             handle_event(Event::hover_event(true));
@@ -306,7 +414,25 @@ void Element::ProcessEvent(Rml::Event &event) {
             if (events_enabled & Events(EventType::Text)) {
                 Rml::Variant *value_variant = base->GetAttribute("value");
                 if (value_variant != nullptr) {
-                    handle_event(Event::text_event(value_variant->Get<std::string>()));
+                    // Reuse one text event per thread so that its string's allocation is kept between events.
+                    // A handler can cause another change event, so fall back to a new event if it's already in use.
+                    static thread_local Event text_event = Event::text_event("");
+                    static thread_local bool text_event_in_use = false;
+                    if (text_event_in_use) {
+                        handle_event(Event::text_event(value_variant->Get<Rml::String>()));
+                    }
+                    else {
+                        std::string &text = std::get<EventText>(text_event.variant).text;
+                        if (value_variant->GetType() == Rml::Variant::STRING) {
+                            text.assign(value_variant->GetReference<Rml::String>());
+                        }
+                        else {
+                            text.assign(value_variant->Get<Rml::String>());
+                        }
+                        text_event_in_use = true;
+                        handle_event(text_event);
+                        text_event_in_use = false;
+                    }
                 }
             }
 
@@ -316,18 +442,11 @@ void Element::ProcessEvent(Rml::Event &event) {
             break;
         }
     }
-
-    if (context != ContextId::null() && did_open) {
-        context.close();
-    }
-
-    if (prev_context != ContextId::null()) {
-        prev_context.open();
-    }
 }
 
 void Element::set_attribute(const Rml::String &attribute_key, const Rml::String &attribute_value) {
     base->SetAttribute(attribute_key, attribute_value);
+    mark_layout_dirty();
 }
 
 void Element::process_event(const Event &) {
@@ -400,6 +519,9 @@ void Element::add_style(Style *style, const std::initializer_list<std::string_vi
 }
 
 void Element::set_enabled(bool enabled) {
+    if (this->enabled != enabled) {
+        invalidate_navigation();
+    }
     this->enabled = enabled;
 
     propagate_disabled(disabled_from_parent);
@@ -409,24 +531,23 @@ bool Element::is_enabled() const {
     return enabled && !disabled_from_parent;
 }
 
-// Adapted from RmlUi's `EncodeRml`.
-std::string escape_rml(std::string_view string)
+// Adapted from RmlUi's `EncodeRml`. Escapes into an existing string in a single pass,
+// which reuses the string's allocation when the text is updated repeatedly.
+static void escape_rml(std::string_view string, std::string& result)
 {
-	std::string result;
-	result.reserve(string.size());
+	result.clear();
 	for (char c : string)
 	{
 		switch (c)
 		{
-		case '<': result += "&lt;"; break;
-		case '>': result += "&gt;"; break;
-		case '&': result += "&amp;"; break;
-		case '"': result += "&quot;"; break;
-        case '\n': result += "<br/>"; break;
-		default: result += c; break;
+		case '<': result.append("&lt;"); break;
+		case '>': result.append("&gt;"); break;
+		case '&': result.append("&amp;"); break;
+		case '"': result.append("&quot;"); break;
+        case '\n': result.append("<br/>"); break;
+		default: result.push_back(c); break;
 		}
 	}
-	return result;
 }
 
 void Element::set_text(std::string_view text) {
@@ -436,7 +557,9 @@ void Element::set_text(std::string_view text) {
         // due to the child elements being deleted while the document is being updated.
         // Queueing them defers it to the update thread, which prevents that issue.
         // Escape the string into Rml to prevent element injection.
-        get_current_context().queue_set_text(this, escape_rml(text));
+        escape_rml(text, pending_text);
+        interned_text_handle = 0;
+        get_current_context().queue_set_text(this);
     }
     else {
         assert(false && "Attempted to set text of an element that cannot have its text set.");
@@ -445,23 +568,46 @@ void Element::set_text(std::string_view text) {
 
 void Element::set_text_unsafe(std::string_view text) {
     if (can_set_text) {
-        get_current_context().queue_set_text(this, std::string(text));
+        pending_text.assign(text);
+        interned_text_handle = 0;
+        get_current_context().queue_set_text(this);
     }
     else {
         assert(false && "Attempted to set text of an element that cannot have its text set.");
     }
 }
 
+void Element::set_interned_text(uint32_t handle, std::string_view text) {
+    if (has_interned_text(handle)) {
+        return;
+    }
+
+    set_text(text);
+    interned_text_handle = handle;
+}
+
 std::string Element::get_input_text() {
     return base->GetAttribute("value", std::string{});
 }
 
 void Element::set_input_text(std::string_view val) {
     base->SetAttribute("value", std::string{ val });
+    mark_layout_dirty();
 }
 
 void Element::set_src(std::string_view src) {
     base->SetAttribute("src", std::string(src));
+    mark_layout_dirty();
+    texture_src_handle = 0;
+}
+
+void Element::set_texture_src(uint32_t texture, std::string_view src) {
+    if (has_texture_src(texture)) {
+        return;
+    }
+
+    set_src(src);
+    texture_src_handle = texture;
 }
 
 void Element::set_style_enabled(std::string_view style_name, bool enable) {
@@ -496,22 +642,38 @@ bool Element::is_style_enabled(std::string_view style_name) {
     return style_active_set.contains(style_name);
 }
 
+const ElementGeometry &Element::get_geometry() {
+    // Elements outside of any context can't have their geometry invalidated, so it's always read directly for them.
+    uint32_t layout_generation = owning_context.get_layout_generation();
+    if (layout_generation == 0 || geometry.layout_generation != layout_generation) {
+        geometry.layout_generation = layout_generation;
+        geometry.absolute_offset = base->GetAbsoluteOffset();
+        geometry.offset = { base->GetOffsetLeft(), base->GetOffsetTop() };
+        geometry.client_offset = { base->GetClientLeft(), base->GetClientTop() };
+        geometry.client_size = { base->GetClientWidth(), base->GetClientHeight() };
+        geometry.box_size = base->GetBox().GetSize();
+    }
+    return geometry;
+}
+
 float Element::get_absolute_left() {
-    return base->GetAbsoluteLeft();
+    return get_geometry().absolute_offset.x;
 }
 
 float Element::get_absolute_top() {
-    return base->GetAbsoluteTop();
+    return get_geometry().absolute_offset.y;
 }
 
 float Element::get_offset_left() {
-    return base->GetOffsetLeft();
+    return get_geometry().offset.x;
 }
 
 float Element::get_offset_top() {
-    return base->GetOffsetTop();
+    return get_geometry().offset.y;
 }
 
+// Scroll offsets are read directly instead of from the cached geometry, as they can change at any point in a frame
+// (e.g. from a scroll event during Update) and are usually read right after.
 float Element::get_scroll_left() {
     return base->GetScrollLeft();
 }
@@ -521,19 +683,19 @@ float Element::get_scroll_top() {
 }
 
 float Element::get_client_left() {
-    return base->GetClientLeft();
+    return get_geometry().client_offset.x;
 }
 
 float Element::get_client_top() {
-    return base->GetClientTop();
+    return get_geometry().client_offset.y;
 }
 
 float Element::get_client_width() {
-    return base->GetClientWidth();
+    return get_geometry().client_size.x;
 }
 
 float Element::get_client_height() {
-    return base->GetClientHeight();
+    return get_geometry().client_size.y;
 }
 
 float Element::get_dp_to_pixel_ratio() {
@@ -592,8 +754,11 @@ void Element::queue_update() {
     cur_context.queue_element_update(resource_id);
 }
 
-void Element::register_callback(ContextId context, PTR(void) callback, PTR(void) userdata) {
-    callbacks.emplace_back(UICallback{.context = context, .callback = callback, .userdata = userdata});
+void Element::register_callback(ContextId context, PTR(void) callback, PTR(void) userdata, uint32_t event_mask, uint32_t coalesce_policies) {
+    UICallback &ui_callback = callbacks.emplace_back(UICallback{.context = context, .callback = callback, .userdata = userdata, .event_mask = event_mask & mod_callback_events});
+    if (coalesce_policies != 0) {
+        ui_callback.coalescer = std::make_shared<UICallbackCoalescer>(coalesce_policies);
+    }
 }
 
 Element *Element::select_add_option(std::string_view text, std::string_view value) {
@@ -653,6 +818,42 @@ void Element::scroll_into_view(bool smooth) {
     }
 
     base->ScrollIntoView(options);
+    owning_context.invalidate_layout();
+}
+
+void Element::animate(const AnimationTrack &track, Style *style) {
+    ContextId context = get_current_context();
+    context.start_animation(this, style == nullptr ? this : style, track);
+}
+
+void Element::stop_animations(Style *style) {
+    ContextId context = get_current_context();
+    context.stop_animations(this, style);
+}
+
+void Element::apply_animated_property(Style *style, Rml::PropertyId property_id, const Rml::Property &property) {
+    if (style == this) {
+        set_property(property_id, property);
+        return;
+    }
+
+    style->set_property(property_id, property);
+
+    // Only write to the Rml element if the style is enabled and no style applied after it sets the same property.
+    Style *applied_style = nullptr;
+    for (size_t i = 0; i < styles.size(); i++) {
+        if (styles_counter[i] == 0 && styles[i]->property_map.contains(property_id)) {
+            applied_style = styles[i];
+        }
+    }
+
+    if (applied_style == style) {
+        if (property_affects_navigation(property_id)) {
+            invalidate_navigation();
+        }
+        base->SetProperty(property_id, property);
+        mark_layout_dirty();
+    }
 }
 
 // Navigation
@@ -669,6 +870,7 @@ Element *Element::get_nav_parent() {
 }
 
 void Element::set_as_navigation_container(NavigationType nav_type) {
+    invalidate_navigation();
     is_nav_container = true;
     this->nav_type = nav_type;
 
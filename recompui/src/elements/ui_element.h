@@ -1,21 +1,73 @@
 #pragma once
 
 #include "ui_style.h"
+#include "ui_animation.h"
 #include "../core/ui_context.h"
 
 #include "recomp.h"
 #include <ultramodern/ultra64.h>
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
 #include <variant>
 
 namespace recompui {
 class Document;
 
+// Event types that can be delivered to callbacks in mod code.
+constexpr uint32_t mod_callback_events = Events(EventType::Click, EventType::Focus, EventType::Hover, EventType::Enable,
+    EventType::Drag, EventType::Update, EventType::MenuAction);
+
+// Coalescing policies for mod callbacks. These match RecompuiCoalescePolicy in event_structs.h.
+enum class CallbackCoalescePolicy : uint32_t {
+    // Drag moves that haven't been dispatched yet are replaced by the newest position.
+    LatestDrag = 1 << 0,
+    // Hover, focus and enable changes that are undone before they're dispatched are dropped in pairs.
+    CancelToggles = 1 << 1,
+};
+
+// Merges events for a mod callback while they wait in the callback queue, as queued events can't be modified once
+// they're in the queue. Shared by every queued copy of the callback.
+class UICallbackCoalescer {
+public:
+    UICallbackCoalescer(uint32_t policies) : policies(policies) {}
+    // Called when an event is queued. Returns false if it was merged into an event that's already queued, otherwise
+    // the serial must be queued along with the event.
+    bool on_queue(const Event &e, uint32_t &serial);
+    // Called when a queued event is dispatched, which replaces it with the merged event. Returns false if the event was cancelled out.
+    bool on_dispatch(Event &e, uint32_t serial);
+private:
+    // State of a hover, focus or enable event that's waiting in the queue.
+    struct QueuedToggle {
+        bool queued = false;
+        bool cancelled = false;
+        bool active = false;
+    };
+
+    std::mutex mutex;
+    uint32_t policies;
+    // The drag move that later moves are merged into. Drag starts and ends are never merged, and moves after them get
+    // queued separately so that they stay in order.
+    bool drag_queued = false;
+    uint32_t drag_serial = 0;
+    EventDrag latest_drag{};
+    QueuedToggle hover;
+    QueuedToggle focus;
+    QueuedToggle enable;
+
+    QueuedToggle *get_toggle(EventType type);
+};
+
 struct UICallback {
     ContextId context;
     PTR(void) callback;
     PTR(void) userdata;
+    // Event types that get queued for the callback.
+    uint32_t event_mask = mod_callback_events;
+    // Only created for callbacks that have coalescing policies.
+    std::shared_ptr<UICallbackCoalescer> coalescer;
 };
 
 using ElementValue = std::variant<uint32_t, float, double, std::monostate>;
@@ -46,6 +98,16 @@ enum class NavigationType {
 class ContextId;
 class RecompNav;
 
+// Geometry read from an element's Rml element, which stays valid until the layout generation changes.
+struct ElementGeometry {
+    uint32_t layout_generation = 0;
+    Rml::Vector2f absolute_offset;
+    Rml::Vector2f offset;
+    Rml::Vector2f client_offset;
+    Rml::Vector2f client_size;
+    Rml::Vector2f box_size;
+};
+
 class Element : public Style, public Rml::EventListener {
     friend ContextId create_context(const std::filesystem::path& path);
     friend ContextId create_context();
@@ -62,7 +124,10 @@ private:
     std::unordered_multimap<std::string_view, uint32_t> style_name_index_map;
     std::vector<UICallback> callbacks;
     Element *parent = nullptr;
+    // Context that this element belongs to, set when the element is added to a context. Used to dispatch events without looking up the document.
+    ContextId owning_context = ContextId::null();
     std::vector<Element *> children;
+    // Only generated when requested through get_id, as most elements never need one.
     std::string id;
     std::string debug_id = "";
     bool shim = false;
@@ -70,6 +135,17 @@ private:
     bool disabled_attribute = false;
     bool disabled_from_parent = false;
     bool can_set_text = false;
+    // Dirty bit for the context's update scheduler. Set while the element is queued for an update event.
+    bool update_queued = false;
+    // Set while the element's pending_text is queued to be applied by the context.
+    bool text_queued = false;
+    // Text that will be applied on the next update, and the text that was last applied to the Rml element.
+    std::string pending_text;
+    std::string current_text;
+    // Handle of the interned string that was last set as this element's text, or 0 if the text came from anywhere else.
+    uint32_t interned_text_handle = 0;
+    // Handle of the mod texture that was last set as this element's src, or 0 if the src came from anywhere else.
+    uint32_t texture_src_handle = 0;
 
     bool is_nav_container = false;
     bool is_nav_wrapping = false;
@@ -78,6 +154,10 @@ private:
 
     std::vector<Element *> nav_children;
 
+    // Cached by get_geometry, since reading the absolute offset walks all of the element's ancestors.
+    ElementGeometry geometry;
+    const ElementGeometry &get_geometry();
+
     void add_child(Element *child);
     void register_event_listeners(uint32_t events_enabled);
     void apply_style(Style *style);
@@ -94,10 +174,19 @@ private:
 
     // Rml::EventListener overrides.
     void ProcessEvent(Rml::Event &event) override final;
+    // Converts an RmlUi event into recompui events for this element. Expects the element's context to be open.
+    void process_rml_event(Rml::Event &event, bool is_target);
+    // Writes an animated value into one of this element's styles and into the Rml element if that style is in effect.
+    void apply_animated_property(Style *style, Rml::PropertyId property_id, const Rml::Property &property);
+    bool handles_rml_event(Rml::EventId event_id) const;
 
     Element *get_nav_parent();
     void get_all_focusable_children(Element *nav_parent);
     void build_navigation(Element *nav_parent, Element *cur_focus_element);
+    // Marks the cached navigation tree of this element's document as stale.
+    void invalidate_navigation();
+    // Tells the element's context that the next layout pass can move elements, see ContextId::mark_layout_dirty.
+    void mark_layout_dirty();
 protected:
     // Use of this method in inherited classes is discouraged unless it's necessary.
     void set_attribute(const Rml::String &attribute_key, const Rml::String &attribute_value);
@@ -106,6 +195,17 @@ protected:
     virtual ElementValue get_element_value() { return std::monostate{}; }
     virtual void set_input_value(const ElementValue&) {}
     virtual std::string_view get_type_name() { return "Element"; }
+    // For composites that need RmlUi events that have no recompui event type. The listener must be removed before it's destroyed.
+    void add_rml_event_listener(Rml::EventId event_id, Rml::EventListener *listener, bool in_capture = false);
+    void remove_rml_event_listener(Rml::EventId event_id, Rml::EventListener *listener, bool in_capture = false);
+    // Must be called by set_text overrides and anything else that changes the text without going through Element::set_text.
+    void clear_interned_text() { interned_text_handle = 0; }
+    // Reorders the children used for navigation without moving their Rml elements, e.g. for absolutely positioned children.
+    template <typename Compare>
+    void sort_children(Compare compare) {
+        std::stable_sort(children.begin(), children.end(), compare);
+        invalidate_navigation();
+    }
 public:
     // Used for backwards compatibility with legacy UI elements.
     Element(ResourceId rid, Rml::Element *base);
@@ -126,9 +226,15 @@ public:
     virtual void set_text(std::string_view text);
     // Only use if you can ensure text is directly from a trusted source. Sets inner rml contents which can create new elements.
     void set_text_unsafe(std::string_view text);
+    // Sets the text from an interned string. Does nothing if the element's text was last set from the same handle.
+    void set_interned_text(uint32_t handle, std::string_view text);
+    bool has_interned_text(uint32_t handle) const { return handle != 0 && interned_text_handle == handle; }
     std::string get_input_text();
     void set_input_text(std::string_view text);
     void set_src(std::string_view src);
+    // Sets the src to a mod texture's source. Does nothing if the element already shows the same texture.
+    void set_texture_src(uint32_t texture, std::string_view src);
+    bool has_texture_src(uint32_t texture) const { return texture != 0 && texture_src_handle == texture; }
     void set_style_enabled(std::string_view style_name, bool enabled);
     bool is_style_enabled(std::string_view style_name);
     void apply_styles();
@@ -150,20 +256,27 @@ public:
     bool focus();
     void blur();
     void queue_update();
-    void register_callback(ContextId context, PTR(void) callback, PTR(void) userdata);
+    // The event mask and coalescing policies are applied when events are queued, so filtered events never reach the queue.
+    void register_callback(ContextId context, PTR(void) callback, PTR(void) userdata, uint32_t event_mask = mod_callback_events, uint32_t coalesce_policies = 0);
     uint32_t get_input_value_u32();
     float get_input_value_float();
     double get_input_value_double();
     void set_input_value_u32(uint32_t val) { set_input_value(val); }
     void set_input_value_float(float val) { set_input_value(val); }
     void set_input_value_double(double val) { set_input_value(val); }
-    const std::string& get_id() { return id; }
+    // Gets the element's id, generating one and assigning it to the Rml element if it doesn't have one yet.
+    const std::string& get_id();
     bool is_pseudo_class_set(Rml::String pseudo_class);
     void scroll_into_view(bool smooth = false);
+    // Animates a property of this element, or of one of the element's styles if one is provided. Animating a style
+    // only affects the element while that style is enabled. Replaces any running animation of the same property.
+    void animate(const AnimationTrack &track, Style *style = nullptr);
+    // Stops this element's animations on the given style, or all of its animations if no style is provided.
+    void stop_animations(Style *style = nullptr);
 
     void set_debug_id(const std::string& new_debug_id) { debug_id = new_debug_id; }
     const std::string& get_debug_id() const { return debug_id; }
-    const std::string& get_debug_id_or_id() const { return debug_id.empty() ? id : debug_id; }
+    const std::string& get_debug_id_or_id() { return debug_id.empty() ? get_id() : debug_id; }
 
     // Marks an element as a container around navigatable elements.
     // It tells the navigation system how directional input should be handled within this element's focusable children.
@@ -187,4 +300,19 @@ public:
 
 void queue_ui_callback(recompui::ResourceId resource, const Event& e, const UICallback& callback);
 
+// Opens a context for the duration of an RmlUi event, closing whichever context was open before and reopening it afterwards.
+// Cooperates with EventDispatchBatch to keep the context open between events when possible.
+class EventContextScope {
+public:
+    EventContextScope(ContextId context);
+    ~EventContextScope();
+    EventContextScope(const EventContextScope&) = delete;
+    EventContextScope& operator=(const EventContextScope&) = delete;
+private:
+    ContextId context;
+    ContextId prev_context = ContextId::null();
+    bool did_open = false;
+    bool was_held = false;
+};
+
 } // namespace recompui
@@ -8,4 +8,8 @@ namespace recompui {
         set_src(src);
     }
 
+    Image::Image(ResourceId rid, Element *parent, uint32_t texture, std::string_view src) : Element(rid, parent, 0, "img") {
+        set_texture_src(texture, src);
+    }
+
 };
\ No newline at end of file
@@ -9,6 +9,8 @@ namespace recompui {
         std::string_view get_type_name() override { return "ImageView"; }
     public:
         Image(ResourceId rid, Element *parent, std::string_view src);
+        // Shows a mod texture given its handle and source.
+        Image(ResourceId rid, Element *parent, uint32_t texture, std::string_view src);
     };
 
 } // namespace recompui
\ No newline at end of file
@@ -9,6 +9,7 @@ namespace recompui {
         case EventType::Text: {
             const EventText &event = std::get<EventText>(e.variant);
             text = event.text;
+            clear_interned_text();
 
             for (const auto &function : text_changed_callbacks) {
                 function(text);
@@ -47,6 +48,7 @@ namespace recompui {
     }
 
     void TextInput::set_text(std::string_view text) {
+        clear_interned_text();
         this->text = std::string(text);
         set_attribute("value", this->text);
     }
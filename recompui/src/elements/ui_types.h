@@ -282,6 +282,40 @@ namespace recompui {
         Tween
     };
 
+    enum class Easing {
+        Linear,
+        QuadIn,
+        QuadOut,
+        QuadInOut,
+        CubicIn,
+        CubicOut,
+        CubicInOut,
+        SineInOut
+    };
+
+    enum class AnimationRepeat {
+        // Plays once and holds the last keyframe.
+        Once,
+        // Restarts from the first keyframe after reaching the last one.
+        Loop,
+        // Alternates between playing forwards and backwards.
+        Yoyo
+    };
+
+    enum class AnimatedProperty {
+        Left,
+        Top,
+        Right,
+        Bottom,
+        Width,
+        Height,
+        Opacity,
+        Color,
+        BackgroundColor,
+        BorderColor,
+        ImageColor
+    };
+
     enum class FontStyle {
         Normal,
         Italic
@@ -0,0 +1,209 @@
+#include "ui_virtual_list.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace recompui {
+
+    void VirtualList::RowListener::ProcessEvent(Rml::Event &event) {
+        EventContextScope context_scope{ list->context };
+
+        switch (event.GetId()) {
+        case Rml::EventId::Scroll:
+            // Ignore scrolling inside of rows. The rows are updated right away instead of being queued, as queued
+            // updates only run at the start of the next frame and this frame would be drawn with the old rows.
+            if (event.GetTargetElement() == event.GetCurrentElement()) {
+                list->update_rows();
+            }
+            break;
+        case Rml::EventId::Focus: {
+            // Focus events don't bubble, so this is received in the capture phase. Scroll the focused row into view
+            // so that the rows next to it get created before navigating to them, which happens in the scroll event.
+            Element *row = list->find_row(list->context.get_element_from_base(event.GetTargetElement()));
+            if (row != nullptr) {
+                row->scroll_into_view();
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    VirtualList::VirtualList(ResourceId rid, Element *parent, float row_height, VirtualListRowFactory row_factory, VirtualListRowBinder row_binder) :
+        Element(rid, parent, Events(EventType::Update)), row_factory(std::move(row_factory)), row_binder(std::move(row_binder)), row_height(row_height)
+    {
+        context = get_current_context();
+
+        set_position(Position::Relative);
+        set_flex(1.0f, 1.0f, 100.0f);
+        set_width(100.0f, Unit::Percent);
+        set_height(100.0f, Unit::Percent);
+        set_max_height(100.0f, Unit::Percent);
+        set_overflow_y(Overflow::Auto);
+        set_as_navigation_container(NavigationType::Vertical);
+
+        // Gives the list its full scroll height, as the rows are absolutely positioned.
+        sizer = context.create_element<Element>(this);
+        sizer->set_width(1.0f, Unit::Px);
+        sizer->set_height(0.0f);
+
+        add_rml_event_listener(Rml::EventId::Scroll, &listener);
+        add_rml_event_listener(Rml::EventId::Focus, &listener, true);
+    }
+
+    VirtualList::~VirtualList() {
+        remove_rml_event_listener(Rml::EventId::Scroll, &listener);
+        remove_rml_event_listener(Rml::EventId::Focus, &listener, true);
+    }
+
+    void VirtualList::set_item_count(size_t item_count) {
+        this->item_count = item_count;
+        sizer->set_height(row_height * item_count);
+
+        for (size_t i = 0; i < active_rows.size();) {
+            if (active_rows[i].first >= item_count) {
+                release_row(active_rows[i].second);
+                active_rows.erase(active_rows.begin() + i);
+            }
+            else {
+                bind_row(active_rows[i].second, active_rows[i].first);
+                i++;
+            }
+        }
+
+        queue_update();
+    }
+
+    void VirtualList::set_overscan(uint32_t overscan) {
+        this->overscan = overscan;
+        queue_update();
+    }
+
+    void VirtualList::refresh_item(size_t index) {
+        Element *row = get_row(index);
+        if (row != nullptr) {
+            bind_row(row, index);
+        }
+    }
+
+    Element *VirtualList::get_row(size_t index) {
+        auto it = std::lower_bound(active_rows.begin(), active_rows.end(), index,
+            [](const std::pair<size_t, Element *> &row, size_t index) { return row.first < index; });
+        if (it != active_rows.end() && it->first == index) {
+            return it->second;
+        }
+        return nullptr;
+    }
+
+    void VirtualList::process_event(const Event &e) {
+        switch (e.type) {
+        case EventType::Update:
+            update_rows();
+            break;
+        default:
+            break;
+        }
+    }
+
+    Element *VirtualList::find_row(Element *element) {
+        while (element != nullptr && element->get_parent() != this) {
+            element = element->get_parent();
+        }
+
+        if (element == nullptr || element == sizer) {
+            return nullptr;
+        }
+
+        return element;
+    }
+
+    void VirtualList::bind_row(Element *row, size_t index) {
+        row->set_top(row_height * index);
+        row_binder(row, index);
+    }
+
+    void VirtualList::release_row(Element *row) {
+        row->display_hide();
+        free_rows.emplace_back(row);
+    }
+
+    void VirtualList::update_rows() {
+        float row_height_px = row_height * get_dp_to_pixel_ratio();
+        float viewport_height = get_client_height();
+        if (item_count > 0 && (row_height_px <= 0.0f || viewport_height <= 0.0f)) {
+            // Not laid out yet, so check again next frame.
+            queue_update();
+            return;
+        }
+
+        float scroll_top = get_scroll_top();
+        size_t first = static_cast<size_t>(std::max(std::floor(scroll_top / row_height_px), 0.0f));
+        size_t last = static_cast<size_t>(std::max(std::ceil((scroll_top + viewport_height) / row_height_px), 0.0f));
+        first = first > overscan ? first - overscan : 0;
+        last = std::min(last + overscan, item_count);
+
+        Element *focused_row = find_row(context.get_focused_element());
+
+        // Release rows that are out of range, except for the focused one.
+        size_t kept_count = 0;
+        for (size_t i = 0; i < active_rows.size(); i++) {
+            auto [index, row] = active_rows[i];
+            if ((index < first || index >= last) && row != focused_row) {
+                release_row(row);
+                continue;
+            }
+            active_rows[kept_count++] = active_rows[i];
+        }
+        active_rows.resize(kept_count);
+
+        // Give every item in range a row.
+        bool added_rows = false;
+        for (size_t index = first; index < last; index++) {
+            if (get_row(index) != nullptr) {
+                continue;
+            }
+
+            Element *row;
+            if (!free_rows.empty()) {
+                row = free_rows.back();
+                free_rows.pop_back();
+                row->display_show();
+            }
+            else {
+                row = row_factory(context, this);
+                assert(row != nullptr && row->get_parent() == this && "Virtual list rows must be created as children of the list.");
+                row->set_position(Position::Absolute);
+                row->set_left(0.0f);
+                row->set_width(100.0f, Unit::Percent);
+                row->set_height(row_height);
+            }
+
+            bind_row(row, index);
+            auto insert_it = std::lower_bound(active_rows.begin(), active_rows.end(), index,
+                [](const std::pair<size_t, Element *> &row, size_t index) { return row.first < index; });
+            active_rows.emplace(insert_it, index, row);
+            added_rows = true;
+        }
+
+        // Keep the children in item order, since vertical navigation follows the order of the children.
+        if (added_rows) {
+            std::unordered_map<const Element *, size_t> row_indices;
+            for (const auto &[index, row] : active_rows) {
+                row_indices.emplace(row, index);
+            }
+
+            auto get_order = [&row_indices](const Element *child) {
+                auto find_it = row_indices.find(child);
+                return find_it == row_indices.end() ? SIZE_MAX : find_it->second;
+            };
+
+            sort_children([&get_order](const Element *lhs, const Element *rhs) {
+                return get_order(lhs) < get_order(rhs);
+            });
+        }
+    }
+
+} // namespace recompui
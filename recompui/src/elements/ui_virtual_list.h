@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ui_element.h"
+
+#include <functional>
+
+namespace recompui {
+
+    // Creates an empty row under the given parent. Rows are reused for different items, so any per-item state belongs in the binder.
+    using VirtualListRowFactory = std::function<Element *(ContextId context, Element *parent)>;
+    // Fills a row with the contents of the item at the given index.
+    using VirtualListRowBinder = std::function<void(Element *row, size_t index)>;
+
+    // Vertical scrolling list of fixed height rows that only keeps elements for the visible rows and a few rows around them.
+    // Rows that scroll out of range are hidden and rebound to other items instead of being destroyed. The row containing
+    // the focused element is kept alive so focus isn't moved to a different item while scrolling.
+    class VirtualList : public Element {
+    public:
+        VirtualList(ResourceId rid, Element *parent, float row_height, VirtualListRowFactory row_factory, VirtualListRowBinder row_binder);
+        virtual ~VirtualList();
+        // Sets the number of items in the list and rebinds every row, as the items may have changed.
+        void set_item_count(size_t item_count);
+        size_t get_item_count() const { return item_count; }
+        // Number of extra rows to keep above and below the visible ones.
+        void set_overscan(uint32_t overscan);
+        // Rebinds the row for an item if it currently has one.
+        void refresh_item(size_t index);
+        // Gets the row currently bound to an item, or null if the item doesn't have a row.
+        Element *get_row(size_t index);
+    protected:
+        void process_event(const Event &e) override;
+        std::string_view get_type_name() override { return "VirtualList"; }
+    private:
+        class RowListener : public Rml::EventListener {
+        public:
+            RowListener(VirtualList *list) : list(list) {}
+            void ProcessEvent(Rml::Event &event) override;
+        private:
+            VirtualList *list;
+        };
+
+        ContextId context;
+        RowListener listener{ this };
+        VirtualListRowFactory row_factory;
+        VirtualListRowBinder row_binder;
+        float row_height;
+        size_t item_count = 0;
+        uint32_t overscan = 4;
+        Element *sizer = nullptr;
+        // Rows that are bound to items, sorted by item index.
+        std::vector<std::pair<size_t, Element *>> active_rows;
+        std::vector<Element *> free_rows;
+
+        Element *find_row(Element *element);
+        void bind_row(Element *row, size_t index);
+        void release_row(Element *row);
+        void update_rows();
+    };
+
+} // namespace recompui
@@ -3,8 +3,10 @@
 #define WIN32_LEAN_AND_MEAN
 #endif
 
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
+#include <mutex>
 
 #include <concurrentqueue.h>
 
@@ -14,6 +16,7 @@
 #include "RmlUi/Core/RenderInterfaceCompatibility.h"
 
 #include "ui_renderer.h"
+#include "core/ui_texture_registry.h"
 
 // TODO: Forced game includes
 #include "InterfaceVS.hlsl.spirv.h"
@@ -91,6 +94,22 @@ struct ImageFromBytes {
     std::vector<char> bytes;
 };
 
+// An RGBA32 image that can be updated after it's created. The full contents are kept on the CPU so that updates can
+// be written at any time without touching the texture, and so the texture can be recreated if RmlUi releases it.
+struct DynamicImage {
+    uint32_t width;
+    uint32_t height;
+    std::vector<char> pixels;
+    // Texture created for this image by LoadTexture, or 0 if it isn't loaded.
+    Rml::TextureHandle texture_handle = 0;
+    // Region that changed since the texture was last uploaded, as a half-open rectangle.
+    bool dirty = false;
+    uint32_t dirty_x0 = 0;
+    uint32_t dirty_y0 = 0;
+    uint32_t dirty_x1 = 0;
+    uint32_t dirty_y1 = 0;
+};
+
 namespace recompui {
 class RmlRenderInterface_RT64_impl : public Rml::RenderInterfaceCompatibility {
     struct DynamicBuffer {
@@ -107,6 +126,10 @@ class RmlRenderInterface_RT64_impl : public Rml::RenderInterfaceCompatibility {
     static constexpr uint32_t initial_upload_buffer_size = 1024 * 1024;
     static constexpr uint32_t initial_vertex_buffer_size = 512 * sizeof(Rml::Vertex);
     static constexpr uint32_t initial_index_buffer_size = 1024 * sizeof(int);
+    // Limits how many bytes of dynamic image updates are uploaded in one frame. Updates past the limit are uploaded on later frames.
+    static constexpr uint32_t dynamic_image_upload_budget = 4 * 1024 * 1024;
+    // Offsets of texture data in buffers must be aligned to this on some backends.
+    static constexpr uint32_t texture_placement_alignment = 512;
     static constexpr plume::RenderFormat RmlTextureFormat = plume::RenderFormat::R8G8B8A8_UNORM;
     static constexpr plume::RenderFormat RmlTextureFormatBgra = plume::RenderFormat::B8G8R8A8_UNORM;
     static constexpr plume::RenderFormat SwapChainFormat = plume::RenderFormat::B8G8R8A8_UNORM;
@@ -156,6 +179,9 @@ class RmlRenderInterface_RT64_impl : public Rml::RenderInterfaceCompatibility {
     std::vector<std::unique_ptr<plume::RenderBuffer>> stale_buffers_{};
     moodycamel::ConcurrentQueue<ImageFromBytes> image_from_bytes_queue;
     std::unordered_map<std::string, ImageFromBytes> image_from_bytes_map;
+    std::mutex dynamic_images_mutex_;
+    // Keyed by mod texture handle.
+    std::unordered_map<uint32_t, DynamicImage> dynamic_images_;
 public:
     RmlRenderInterface_RT64_impl(plume::RenderInterface* interface, plume::RenderDevice* device) {
         interface_ = interface;
@@ -422,6 +448,10 @@ public:
     }
 
     bool LoadTexture(Rml::TextureHandle& texture_handle, Rml::Vector2i& texture_dimensions, const Rml::String& source) override {
+        if (load_dynamic_image(texture_handle, texture_dimensions, source)) {
+            return true;
+        }
+
         flush_image_from_bytes_queue();
 
         auto it = image_from_bytes_map.find(source);
@@ -570,6 +600,95 @@ public:
         if (texture > 1) {
             // Textures #0 and #1 are reserved and should never be released.
             textures_.erase(texture);
+
+            std::lock_guard lock{ dynamic_images_mutex_ };
+            for (auto &[mod_texture, image] : dynamic_images_) {
+                if (image.texture_handle == texture) {
+                    image.texture_handle = 0;
+                }
+            }
+        }
+    }
+
+    bool load_dynamic_image(Rml::TextureHandle& texture_handle, Rml::Vector2i& texture_dimensions, const Rml::String& source) {
+        uint32_t texture;
+        if (!parse_texture_source(source, texture)) {
+            return false;
+        }
+
+        std::lock_guard lock{ dynamic_images_mutex_ };
+        auto it = dynamic_images_.find(texture);
+        if (it == dynamic_images_.end()) {
+            return false;
+        }
+
+        // Create the texture from the current contents, which makes any pending update redundant.
+        DynamicImage &image = it->second;
+        Rml::Vector2i dimensions{ int(image.width), int(image.height) };
+        texture_handle = texture_count_++;
+        if (!create_texture(texture_handle, reinterpret_cast<const Rml::byte*>(image.pixels.data()), dimensions)) {
+            texture_handle = 1;
+            texture_dimensions = Rml::Vector2i{ 1, 1 };
+            return true;
+        }
+
+        image.texture_handle = texture_handle;
+        image.dirty = false;
+        texture_dimensions = dimensions;
+        return true;
+    }
+
+    // Records copies of the changed regions of loaded dynamic images into the frame's command list. The data goes through
+    // the per-frame upload buffer, so nothing waits on the copy and the CPU-side image can be updated again immediately.
+    void upload_dynamic_images() {
+        std::lock_guard lock{ dynamic_images_mutex_ };
+        uint32_t budget_remaining = dynamic_image_upload_budget;
+        bool uploaded_any = false;
+
+        for (auto &[mod_texture, image] : dynamic_images_) {
+            if (!image.dirty || image.texture_handle == 0) {
+                continue;
+            }
+
+            auto texture_it = textures_.find(image.texture_handle);
+            if (texture_it == textures_.end()) {
+                continue;
+            }
+
+            uint32_t region_width = image.dirty_x1 - image.dirty_x0;
+            uint32_t region_height = image.dirty_y1 - image.dirty_y0;
+            uint32_t row_pitch = region_width * RmlTextureFormatBytesPerPixel;
+            uint32_t row_byte_width, row_byte_padding;
+            CalculateTextureRowWidthPadding(row_pitch, row_byte_width, row_byte_padding);
+            uint32_t uploaded_size_bytes = row_byte_width * region_height;
+
+            // Leave the update for a later frame if it doesn't fit in the budget. The first upload of a frame is always
+            // allowed so that images larger than the budget still get updated.
+            if (uploaded_any && uploaded_size_bytes > budget_remaining) {
+                continue;
+            }
+            budget_remaining -= std::min(uploaded_size_bytes, budget_remaining);
+            uploaded_any = true;
+
+            uint32_t offset = allocate_dynamic_data_aligned(upload_buffer_, uploaded_size_bytes, texture_placement_alignment);
+            uint8_t* dst_data = upload_buffer_.mapped_data_ + offset;
+            const char* src_data = image.pixels.data() + (size_t(image.dirty_y0) * image.width + image.dirty_x0) * RmlTextureFormatBytesPerPixel;
+            for (uint32_t row = 0; row < region_height; row++) {
+                memcpy(dst_data, src_data, row_pitch);
+                src_data += size_t(image.width) * RmlTextureFormatBytesPerPixel;
+                dst_data += row_byte_width;
+            }
+
+            TextureHandle &texture_handle = texture_it->second;
+            list_->barriers(plume::RenderBarrierStage::COPY, plume::RenderTextureBarrier(texture_handle.texture.get(), plume::RenderTextureLayout::COPY_DEST));
+            list_->copyTextureRegion(
+                plume::RenderTextureCopyLocation::Subresource(texture_handle.texture.get()),
+                plume::RenderTextureCopyLocation::PlacedFootprint(upload_buffer_.buffer_.get(), RmlTextureFormat, region_width, region_height, 1, row_byte_width / RmlTextureFormatBytesPerPixel, offset),
+                image.dirty_x0, image.dirty_y0);
+
+            // Transition the texture back before it's next drawn with.
+            texture_handle.transitioned = false;
+            image.dirty = false;
         }
     }
 
@@ -620,6 +739,8 @@ public:
         reset_dynamic_buffer(vertex_buffer_);
         reset_dynamic_buffer(index_buffer_);
 
+        upload_dynamic_images();
+
         // Set an internal texture as the render target if MSAA is enabled.
         if (multisampling_.sampleCount > 1) {
             list->barriers(plume::RenderBarrierStage::GRAPHICS, plume::RenderTextureBarrier(screen_texture_ms_.get(), plume::RenderTextureLayout::COLOR_WRITE));
@@ -681,6 +802,77 @@ public:
             image_from_bytes_map.emplace(std::move(image_from_bytes.name), std::move(image_from_bytes));
         }
     }
+
+    void create_dynamic_image(uint32_t texture, uint32_t width, uint32_t height) {
+        std::lock_guard lock{ dynamic_images_mutex_ };
+        auto [it, inserted] = dynamic_images_.try_emplace(texture);
+        assert(inserted && "Dynamic image created twice.");
+
+        DynamicImage &image = it->second;
+        image.width = width;
+        image.height = height;
+        image.pixels.assign(size_t(width) * height * RmlTextureFormatBytesPerPixel, 0);
+    }
+
+    bool update_dynamic_image(uint32_t texture, const char *bytes, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        std::lock_guard lock{ dynamic_images_mutex_ };
+        auto it = dynamic_images_.find(texture);
+        if (it == dynamic_images_.end()) {
+            return false;
+        }
+
+        DynamicImage &image = it->second;
+        if (x > image.width || y > image.height || width > image.width - x || height > image.height - y) {
+            return false;
+        }
+
+        if (width == 0 || height == 0) {
+            return true;
+        }
+
+        size_t src_row_pitch = size_t(width) * RmlTextureFormatBytesPerPixel;
+        size_t dst_row_pitch = size_t(image.width) * RmlTextureFormatBytesPerPixel;
+        char* dst_data = image.pixels.data() + y * dst_row_pitch + size_t(x) * RmlTextureFormatBytesPerPixel;
+        for (uint32_t row = 0; row < height; row++) {
+            memcpy(dst_data, bytes, src_row_pitch);
+            bytes += src_row_pitch;
+            dst_data += dst_row_pitch;
+        }
+
+        // Grow the dirty region to cover the update. Several updates in one frame get merged into a single upload.
+        if (image.dirty) {
+            image.dirty_x0 = std::min(image.dirty_x0, x);
+            image.dirty_y0 = std::min(image.dirty_y0, y);
+            image.dirty_x1 = std::max(image.dirty_x1, x + width);
+            image.dirty_y1 = std::max(image.dirty_y1, y + height);
+        }
+        else {
+            image.dirty = true;
+            image.dirty_x0 = x;
+            image.dirty_y0 = y;
+            image.dirty_x1 = x + width;
+            image.dirty_y1 = y + height;
+        }
+
+        return true;
+    }
+
+    bool get_dynamic_image_size(uint32_t texture, uint32_t &width, uint32_t &height) {
+        std::lock_guard lock{ dynamic_images_mutex_ };
+        auto it = dynamic_images_.find(texture);
+        if (it == dynamic_images_.end()) {
+            return false;
+        }
+
+        width = it->second.width;
+        height = it->second.height;
+        return true;
+    }
+
+    void release_dynamic_image(uint32_t texture) {
+        std::lock_guard lock{ dynamic_images_mutex_ };
+        dynamic_images_.erase(texture);
+    }
 };
 } // namespace recompui
 
@@ -725,3 +917,27 @@ void recompui::RmlRenderInterface_RT64::queue_image_from_bytes_rgba32(const std:
 
     impl->queue_image_from_bytes_rgba32(src, bytes, width, height);
 }
+
+void recompui::RmlRenderInterface_RT64::create_dynamic_image(uint32_t texture, uint32_t width, uint32_t height) {
+    assert(static_cast<bool>(impl));
+
+    impl->create_dynamic_image(texture, width, height);
+}
+
+bool recompui::RmlRenderInterface_RT64::update_dynamic_image(uint32_t texture, const char *bytes, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    assert(static_cast<bool>(impl));
+
+    return impl->update_dynamic_image(texture, bytes, x, y, width, height);
+}
+
+bool recompui::RmlRenderInterface_RT64::get_dynamic_image_size(uint32_t texture, uint32_t &width, uint32_t &height) {
+    assert(static_cast<bool>(impl));
+
+    return impl->get_dynamic_image_size(texture, width, height);
+}
+
+void recompui::RmlRenderInterface_RT64::release_dynamic_image(uint32_t texture) {
+    assert(static_cast<bool>(impl));
+
+    impl->release_dynamic_image(texture);
+}
@@ -32,6 +32,10 @@ namespace recompui {
         void end(plume::RenderCommandList* list, plume::RenderFramebuffer* framebuffer);
         void queue_image_from_bytes_file(const std::string &src, const std::vector<char> &bytes);
         void queue_image_from_bytes_rgba32(const std::string &src, const std::vector<char> &bytes, uint32_t width, uint32_t height);
+        void create_dynamic_image(uint32_t texture, uint32_t width, uint32_t height);
+        bool update_dynamic_image(uint32_t texture, const char *bytes, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+        bool get_dynamic_image_size(uint32_t texture, uint32_t &width, uint32_t &height);
+        void release_dynamic_image(uint32_t texture);
     };
 } // namespace recompui
 
@@ -0,0 +1,133 @@
+#include "rdram_copy.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define RDRAM_COPY_SIMD
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   include "sse2neon.h"
+#   define RDRAM_COPY_SIMD
+#endif
+
+namespace recompui {
+    static constexpr gpr rdram_base = 0xFFFFFFFF80000000ULL;
+
+    thread_local uint64_t rdram_bytes_copied = 0;
+
+    uint64_t get_rdram_bytes_copied() {
+        return rdram_bytes_copied;
+    }
+
+    static inline uint32_t byteswap32(uint32_t value) {
+        return ((value & 0x000000FFu) << 24) | ((value & 0x0000FF00u) << 8) | ((value & 0x00FF0000u) >> 8) | ((value & 0xFF000000u) >> 24);
+    }
+
+#ifdef RDRAM_COPY_SIMD
+    // Reverses the bytes of every 32-bit lane. SSE2 has no byte shuffle, so swap the 16-bit halves of each lane first
+    // and then the bytes within each half.
+    static inline __m128i byteswap_lanes(__m128i value) {
+        value = _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0xB1), 0xB1);
+        return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+    }
+#endif
+
+    // Copies whole words from one buffer to another while swapping the bytes of each word. The swap is its own inverse,
+    // so this is used for both directions. Neither pointer has to be aligned.
+    static void copy_swapped_words(uint8_t* dst, const uint8_t* src, size_t word_count) {
+        size_t i = 0;
+#ifdef RDRAM_COPY_SIMD
+        for (; i + 4 <= word_count; i += 4) {
+            __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), byteswap_lanes(words));
+        }
+#endif
+        for (; i < word_count; i++) {
+            uint32_t word;
+            memcpy(&word, src + i * 4, sizeof(word));
+            word = byteswap32(word);
+            memcpy(dst + i * 4, &word, sizeof(word));
+        }
+    }
+
+    void copy_from_rdram(uint8_t* rdram, void* dst, gpr src_addr, size_t size) {
+        uint8_t* dst_bytes = reinterpret_cast<uint8_t*>(dst);
+        gpr offset = src_addr - rdram_base;
+        rdram_bytes_copied += size;
+
+        // Copy bytes individually until the source is word aligned.
+        while (size > 0 && (offset & 3) != 0) {
+            *dst_bytes++ = rdram[offset ^ 3];
+            offset++;
+            size--;
+        }
+
+        size_t word_count = size / 4;
+        copy_swapped_words(dst_bytes, rdram + offset, word_count);
+        dst_bytes += word_count * 4;
+        offset += word_count * 4;
+        size -= word_count * 4;
+
+        // Copy any remaining bytes that don't fill a word.
+        while (size > 0) {
+            *dst_bytes++ = rdram[offset ^ 3];
+            offset++;
+            size--;
+        }
+    }
+
+    void copy_to_rdram(uint8_t* rdram, gpr dst_addr, const void* src, size_t size) {
+        const uint8_t* src_bytes = reinterpret_cast<const uint8_t*>(src);
+        gpr offset = dst_addr - rdram_base;
+        rdram_bytes_copied += size;
+
+        while (size > 0 && (offset & 3) != 0) {
+            rdram[offset ^ 3] = *src_bytes++;
+            offset++;
+            size--;
+        }
+
+        size_t word_count = size / 4;
+        copy_swapped_words(rdram + offset, src_bytes, word_count);
+        src_bytes += word_count * 4;
+        offset += word_count * 4;
+        size -= word_count * 4;
+
+        while (size > 0) {
+            rdram[offset ^ 3] = *src_bytes++;
+            offset++;
+            size--;
+        }
+    }
+
+    size_t rdram_strlen(uint8_t* rdram, gpr addr) {
+        gpr offset = addr - rdram_base;
+        size_t len = 0;
+
+        while ((offset & 3) != 0) {
+            if (rdram[offset ^ 3] == 0x00) {
+                return len;
+            }
+            offset++;
+            len++;
+        }
+
+        // Skip over whole words until one of them contains a null byte. The byte order doesn't matter for this check.
+        while (true) {
+            uint32_t word;
+            memcpy(&word, rdram + offset, sizeof(word));
+            if (((word - 0x01010101u) & ~word & 0x80808080u) != 0) {
+                break;
+            }
+            offset += 4;
+            len += 4;
+        }
+
+        while (rdram[offset ^ 3] != 0x00) {
+            offset++;
+            len++;
+        }
+
+        return len;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef __RDRAM_COPY_H__
+#define __RDRAM_COPY_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "recomp.h"
+
+namespace recompui {
+    // Bulk transfers between host memory and rdram. rdram is stored as byteswapped 32-bit words, so these produce the same
+    // result as a MEM_B loop over every byte, but swap a whole vector of words at a time for the aligned part of the range.
+    void copy_from_rdram(uint8_t* rdram, void* dst, gpr src_addr, size_t size);
+    void copy_to_rdram(uint8_t* rdram, gpr dst_addr, const void* src, size_t size);
+    // Length of a null-terminated string in rdram, not counting the terminator.
+    size_t rdram_strlen(uint8_t* rdram, gpr addr);
+    // Total bytes copied in either direction by the current thread, used to measure how much data UI exports transfer.
+    uint64_t get_rdram_bytes_copied();
+}
+
+#endif
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/ui_context.h"
+#include "elements/ui_animation.h"
+#include "elements/ui_element.h"
+#include "elements/ui_document.h"
+#include "headless_ui.h"
+#include "test_common.h"
+
+using namespace recompui;
+
+namespace {
+    Rml::Context *rml_context = nullptr;
+
+    // Appends itself to a log whenever it receives an update event, then runs an optional handler.
+    class RecordingElement : public Element {
+    protected:
+        std::string_view get_type_name() override { return "RecordingElement"; }
+        void process_event(const Event &e) override {
+            if (e.type == EventType::Update) {
+                log->emplace_back(this);
+                if (on_update) {
+                    on_update();
+                }
+            }
+        }
+    public:
+        RecordingElement(ResourceId rid, Element *parent, std::vector<Element *> *log, bool can_set_text = false) :
+            Element(rid, parent, Events(EventType::Update), "div", can_set_text), log(log) {}
+        std::function<void()> on_update;
+    private:
+        std::vector<Element *> *log;
+    };
+
+    // Gets the text that was applied to an element's Rml element.
+    std::string get_applied_text(ContextId context, Element *element) {
+        Rml::Element *base = test::get_rml_element(context, element);
+        return base == nullptr ? std::string{} : base->GetInnerRML();
+    }
+
+    void test_update_order() {
+        test::TestDocument doc{ rml_context };
+        std::vector<Element *> log;
+        RecordingElement *a = doc.context.create_element<RecordingElement>(doc.root, &log);
+        RecordingElement *a_child = doc.context.create_element<RecordingElement>(a, &log);
+        RecordingElement *a_grandchild = doc.context.create_element<RecordingElement>(a_child, &log);
+        RecordingElement *b = doc.context.create_element<RecordingElement>(doc.root, &log);
+        RecordingElement *b_child = doc.context.create_element<RecordingElement>(b, &log);
+
+        // Every element gets one update when it's created, in creation order within each depth.
+        doc.context.process_updates();
+        TEST_CHECK((log == std::vector<Element *>{ a, b, a_child, b_child, a_grandchild }));
+
+        // Parents are updated before their children no matter what order they were queued in, elements at the same
+        // depth are updated in the order they were queued, and queueing an element twice only updates it once.
+        log.clear();
+        a_grandchild->queue_update();
+        b_child->queue_update();
+        a->queue_update();
+        b->queue_update();
+        a_child->queue_update();
+        a->queue_update();
+        doc.context.process_updates();
+        TEST_CHECK((log == std::vector<Element *>{ a, b, b_child, a_child, a_grandchild }));
+
+        UpdateStats stats = doc.context.get_update_stats();
+        TEST_CHECK(stats.queued_updates == 5);
+        TEST_CHECK(stats.update_events == 5);
+        TEST_CHECK(stats.dropped_updates == 0);
+
+        // Nothing is left over for the next frame.
+        log.clear();
+        doc.context.process_updates();
+        TEST_CHECK(log.empty());
+        TEST_CHECK(doc.context.get_update_stats().update_events == 0);
+    }
+
+    void test_update_order_is_repeatable() {
+        // Builds the same tree and queues the same updates in two separate contexts, which must produce the same order.
+        auto run = [](std::vector<size_t> &order) {
+            test::TestDocument doc{ rml_context };
+            std::vector<Element *> log;
+            std::vector<Element *> elements;
+            for (size_t i = 0; i < 8; i++) {
+                Element *parent = i < 2 ? static_cast<Element *>(doc.root) : elements[i / 2 - 1];
+                elements.emplace_back(doc.context.create_element<RecordingElement>(parent, &log));
+            }
+            doc.context.process_updates();
+
+            log.clear();
+            for (size_t i : { 7, 3, 5, 0, 6, 1, 4, 2 }) {
+                elements[i]->queue_update();
+            }
+            doc.context.process_updates();
+
+            for (Element *element : log) {
+                order.emplace_back(std::find(elements.begin(), elements.end(), element) - elements.begin());
+            }
+        };
+
+        std::vector<size_t> first_order;
+        std::vector<size_t> second_order;
+        run(first_order);
+        run(second_order);
+        TEST_CHECK((first_order == std::vector<size_t>{ 0, 1, 3, 5, 4, 2, 7, 6 }));
+        TEST_CHECK(first_order == second_order);
+    }
+
+    void test_requeue_during_update() {
+        test::TestDocument doc{ rml_context };
+        std::vector<Element *> log;
+        RecordingElement *element = doc.context.create_element<RecordingElement>(doc.root, &log);
+        element->on_update = [element]() { element->queue_update(); };
+
+        // An element that queues itself while being updated is updated again on the next frame, not in a loop.
+        doc.context.process_updates();
+        TEST_CHECK(log.size() == 1);
+        doc.context.process_updates();
+        TEST_CHECK(log.size() == 2);
+        TEST_CHECK(doc.context.get_update_stats().update_events == 1);
+
+        element->on_update = nullptr;
+        doc.context.process_updates();
+        doc.context.process_updates();
+        TEST_CHECK(log.size() == 3);
+    }
+
+    void test_destroyed_before_update() {
+        test::TestDocument doc{ rml_context };
+        std::vector<Element *> log;
+        RecordingElement *parent = doc.context.create_element<RecordingElement>(doc.root, &log);
+        RecordingElement *child = doc.context.create_element<RecordingElement>(parent, &log);
+        doc.context.process_updates();
+
+        log.clear();
+        child->queue_update();
+        parent->queue_update();
+        parent->remove_child(child);
+        doc.context.process_updates();
+
+        TEST_CHECK((log == std::vector<Element *>{ parent }));
+        UpdateStats stats = doc.context.get_update_stats();
+        TEST_CHECK(stats.queued_updates == 2);
+        TEST_CHECK(stats.update_events == 1);
+        TEST_CHECK(stats.dropped_updates == 1);
+    }
+
+    void test_text_after_updates() {
+        test::TestDocument doc{ rml_context };
+        std::vector<Element *> log;
+        RecordingElement *parent = doc.context.create_element<RecordingElement>(doc.root, &log);
+        RecordingElement *label = doc.context.create_element<RecordingElement>(parent, &log, true);
+        doc.context.process_updates();
+
+        // Text set from an update event is applied in the same frame, as the text phase runs after every update.
+        // Only the last assignment is applied.
+        parent->on_update = [label]() {
+            label->set_text("first");
+            label->set_text("second");
+        };
+        parent->queue_update();
+        doc.context.process_updates();
+
+        UpdateStats stats = doc.context.get_update_stats();
+        TEST_CHECK(stats.update_events == 1);
+        TEST_CHECK(stats.text_updates == 1);
+        TEST_CHECK(stats.text_updates_coalesced == 1);
+        TEST_CHECK(get_applied_text(doc.context, label) == "second");
+
+        // Setting the text the element already has doesn't queue anything.
+        parent->on_update = nullptr;
+        label->set_text("second");
+        doc.context.process_updates();
+        stats = doc.context.get_update_stats();
+        TEST_CHECK(stats.text_updates == 0);
+        TEST_CHECK(stats.text_updates_skipped == 1);
+
+        // Text that's set and then set back before the frame ends is skipped when it's applied.
+        label->set_text("third");
+        label->set_text("second");
+        doc.context.process_updates();
+        stats = doc.context.get_update_stats();
+        TEST_CHECK(stats.text_updates == 0);
+        TEST_CHECK(stats.text_updates_skipped == 1);
+        TEST_CHECK(get_applied_text(doc.context, label) == "second");
+    }
+
+    void test_attach_detached_subtree() {
+        test::TestDocument doc{ rml_context };
+        std::vector<Element *> log;
+        Element *container = doc.context.create_element<RecordingElement>(doc.root, &log);
+        RecordingElement *detached = doc.context.create_detached_element<RecordingElement>(&log);
+        RecordingElement *child = doc.context.create_element<RecordingElement>(detached, &log);
+
+        // The staged subtree isn't part of the document until it's attached.
+        Rml::ElementDocument *document = doc.context.get_document();
+        TEST_CHECK(document->GetElementById(child->get_id()) == nullptr);
+
+        // Attaching with the context closed takes the context lock for the attach and releases it afterwards.
+        doc.context.close();
+        doc.context.attach_element(detached, container);
+        TEST_CHECK(try_get_current_context() == ContextId::null());
+
+        Rml::Element *child_base = document->GetElementById(child->get_id());
+        TEST_CHECK(child_base != nullptr);
+        TEST_CHECK(child_base != nullptr && child_base->GetParentNode() == document->GetElementById(detached->get_id()));
+
+        // Attached elements aren't detached anymore, so they can't be destroyed as such.
+        doc.context.open();
+        TEST_CHECK(!doc.context.destroy_detached_element(detached));
+    }
+
+    void test_frame_work() {
+        test::TestDocument doc{ rml_context };
+        std::vector<Element *> log;
+        RecordingElement *element = doc.context.create_element<RecordingElement>(doc.root, &log);
+
+        // A queued update is the only work until an animation starts.
+        TEST_CHECK(!doc.context.has_frame_work());
+        element->queue_update();
+        TEST_CHECK(doc.context.has_frame_work());
+        TEST_CHECK(!doc.context.is_animating());
+        doc.context.process_updates();
+        TEST_CHECK(!doc.context.has_frame_work());
+
+        advance_animation_clock();
+        element->animate(AnimationTrack::tween(AnimatedProperty::Opacity, 0.0f, 1.0f, 1000.0f).set_repeat(AnimationRepeat::Loop));
+        TEST_CHECK(doc.context.is_animating());
+
+        // Reading the state from another thread works with the context closed, and reports a context that's open
+        // elsewhere as busy.
+        doc.context.close();
+        TEST_CHECK(doc.context.is_animating());
+        TEST_CHECK(!doc.context.has_frame_work());
+        doc.context.open();
+        bool other_thread_animating = false;
+        bool other_thread_work = false;
+        std::thread([&]() {
+            other_thread_animating = doc.context.is_animating();
+            other_thread_work = doc.context.has_frame_work();
+        }).join();
+        TEST_CHECK(other_thread_animating);
+        TEST_CHECK(other_thread_work);
+
+        element->stop_animations();
+        TEST_CHECK(!doc.context.is_animating());
+
+        // Finished animations are dropped when they're processed.
+        element->animate(AnimationTrack::tween(AnimatedProperty::Opacity, 0.0f, 1.0f, 0.0f));
+        TEST_CHECK(doc.context.is_animating());
+        advance_animation_clock();
+        doc.context.process_animations();
+        TEST_CHECK(!doc.context.is_animating());
+    }
+
+    // Builds a container with a few children, a styled label and a staged subtree, then destroys all of it.
+    void churn_once(ContextId context, Document *root, std::vector<Element *> *log) {
+        RecordingElement *container = context.create_element<RecordingElement>(root, log);
+        for (size_t i = 0; i < 4; i++) {
+            RecordingElement *row = context.create_element<RecordingElement>(container, log);
+            context.create_element<RecordingElement>(row, log);
+        }
+
+        Style *style = context.create_style();
+        RecordingElement *label = context.create_element<RecordingElement>(container, log, true);
+        label->add_style(style, "churn");
+        label->set_text("churn");
+
+        RecordingElement *attached = context.create_detached_element<RecordingElement>(log);
+        context.create_element<RecordingElement>(attached, log);
+        context.attach_element(attached, container);
+
+        RecordingElement *never_attached = context.create_detached_element<RecordingElement>(log);
+        context.create_element<RecordingElement>(never_attached, log);
+        TEST_CHECK(context.destroy_detached_element(never_attached));
+
+        // Run a frame's worth of updates so nothing is left queued, then tear everything down.
+        context.process_updates();
+        TEST_CHECK(root->remove_child(container->get_resource_id()));
+        context.destroy_resource(style);
+    }
+
+    void test_resource_churn() {
+        test::TestDocument doc{ rml_context };
+        std::vector<Element *> log;
+        doc.context.set_resource_tracking(true);
+
+        // Elements that live for the whole test, so the baseline isn't just an empty context.
+        RecordingElement *header = doc.context.create_element<RecordingElement>(doc.root, &log);
+        doc.context.create_element<RecordingElement>(header, &log);
+        doc.context.process_updates();
+        ResourceStats baseline = doc.context.get_resource_stats();
+
+        // The first round can grow the context's containers, so memory is compared from the second round on.
+        churn_once(doc.context, doc.root, &log);
+        ResourceStats after_first = doc.context.get_resource_stats();
+
+        for (size_t i = 0; i < 100; i++) {
+            churn_once(doc.context, doc.root, &log);
+        }
+        ResourceStats after_churn = doc.context.get_resource_stats();
+
+        for (const ResourceStats &stats : { after_first, after_churn }) {
+            TEST_CHECK(stats.elements == baseline.elements);
+            TEST_CHECK(stats.styles == baseline.styles);
+            TEST_CHECK(stats.elements_by_type == baseline.elements_by_type);
+            TEST_CHECK(stats.loose_elements == baseline.loose_elements);
+            TEST_CHECK(stats.queued_updates == 0);
+            TEST_CHECK(stats.queued_text == 0);
+            TEST_CHECK(stats.orphaned_elements == 0);
+        }
+        TEST_CHECK(after_churn.approximate_memory == after_first.approximate_memory);
+        TEST_CHECK(doc.context.get_orphaned_resources().empty());
+
+        // Removing an element from its parent without destroying it is reported as a leak, labelled with its origin.
+        RecordingElement *leaked;
+        {
+            ResourceOriginScope origin{ "resource_churn" };
+            leaked = doc.context.create_element<RecordingElement>(header, &log);
+        }
+        header->remove_child(leaked->get_resource_id(), false);
+        std::vector<TrackedResource> orphaned = doc.context.get_orphaned_resources();
+        TEST_CHECK(orphaned.size() == 1);
+        TEST_CHECK(orphaned.size() == 1 && orphaned[0].resource == leaked->get_resource_id());
+        TEST_CHECK(orphaned.size() == 1 && orphaned[0].origin == "resource_churn");
+        doc.context.destroy_resource(leaked);
+        TEST_CHECK(doc.context.get_orphaned_resources().empty());
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    test::HeadlessRml rml{ "context_tests" };
+    rml_context = rml.context;
+
+    return test::run_tests({
+        { "update_order", test_update_order },
+        { "update_order_is_repeatable", test_update_order_is_repeatable },
+        { "requeue_during_update", test_requeue_during_update },
+        { "destroyed_before_update", test_destroyed_before_update },
+        { "text_after_updates", test_text_after_updates },
+        { "attach_detached_subtree", test_attach_detached_subtree },
+        { "resource_churn", test_resource_churn },
+        { "frame_work", test_frame_work },
+    }, argc > 1 ? argv[1] : "");
+}
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/ui_context.h"
+#include "elements/ui_element.h"
+#include "elements/ui_document.h"
+#include "headless_ui.h"
+#include "test_common.h"
+
+using namespace recompui;
+
+namespace {
+    Rml::Context *rml_context = nullptr;
+
+    // Counts the clicks it receives and records which context was open while handling them.
+    class ClickElement : public Element {
+    protected:
+        std::string_view get_type_name() override { return "ClickElement"; }
+        void process_event(const Event &e) override {
+            if (e.type == EventType::Click) {
+                clicks++;
+                context_during_click = try_get_current_context();
+            }
+        }
+    public:
+        ClickElement(ResourceId rid, Element *parent) : Element(rid, parent, Events(EventType::Click)) {}
+        uint32_t clicks = 0;
+        ContextId context_during_click = ContextId::null();
+    };
+
+    // Appends its name to a log whenever it receives a click or gains focus.
+    class LoggingElement : public Element {
+    protected:
+        std::string_view get_type_name() override { return "LoggingElement"; }
+        void process_event(const Event &e) override {
+            if (e.type == EventType::Click) {
+                log->emplace_back(name);
+            }
+            else if (e.type == EventType::Focus && std::get<EventFocus>(e.variant).active) {
+                log->emplace_back(name + " focus");
+            }
+        }
+    public:
+        LoggingElement(ResourceId rid, Element *parent, std::vector<std::string> *log, std::string name) :
+            Element(rid, parent, Events(EventType::Click, EventType::Focus)), log(log), name(std::move(name)) {}
+    private:
+        std::vector<std::string> *log;
+        std::string name;
+    };
+
+    // A plain RmlUi listener, like the ones RmlUi widgets and legacy documents add, that can stop the event.
+    class LoggingListener : public Rml::EventListener {
+    public:
+        enum class Stop { None, Propagation, Immediate };
+        LoggingListener(std::vector<std::string> *log, std::string name, Stop stop = Stop::None) : log(log), name(std::move(name)), stop(stop) {}
+        void ProcessEvent(Rml::Event &event) override {
+            log->emplace_back(name);
+            if (stop == Stop::Propagation) {
+                event.StopPropagation();
+            }
+            else if (stop == Stop::Immediate) {
+                event.StopImmediatePropagation();
+            }
+        }
+    private:
+        std::vector<std::string> *log;
+        std::string name;
+        Stop stop;
+    };
+
+    // A grandparent, parent and child that all handle clicks and focus.
+    struct ClickTree {
+        LoggingElement *grandparent;
+        LoggingElement *parent;
+        LoggingElement *child;
+
+        ClickTree(test::TestDocument &doc, std::vector<std::string> *log) {
+            grandparent = doc.context.create_element<LoggingElement>(doc.root, log, "grandparent");
+            parent = doc.context.create_element<LoggingElement>(grandparent, log, "parent");
+            child = doc.context.create_element<LoggingElement>(parent, log, "child");
+            doc.context.close();
+        }
+    };
+
+    void click(ContextId context, Element *element) {
+        Rml::Element *base = test::get_rml_element(context, element);
+        TEST_CHECK(base != nullptr);
+        if (base != nullptr) {
+            base->DispatchEvent(Rml::EventId::Click, Rml::Dictionary{});
+        }
+    }
+
+    void test_unbatched_dispatch_closes_context() {
+        test::TestDocument doc{ rml_context };
+        ClickElement *element = doc.context.create_element<ClickElement>(doc.root);
+        doc.context.close();
+
+        click(doc.context, element);
+        TEST_CHECK(element->clicks == 1);
+        TEST_CHECK(element->context_during_click == doc.context);
+        TEST_CHECK(try_get_current_context() == ContextId::null());
+    }
+
+    void test_batch_holds_context() {
+        test::TestDocument doc{ rml_context };
+        ClickElement *element = doc.context.create_element<ClickElement>(doc.root);
+        doc.context.close();
+
+        {
+            EventDispatchBatch batch{};
+            // The context stays open between events for as long as the batch is alive.
+            click(doc.context, element);
+            TEST_CHECK(try_get_current_context() == doc.context);
+            click(doc.context, element);
+            TEST_CHECK(try_get_current_context() == doc.context);
+            TEST_CHECK(element->clicks == 2);
+        }
+
+        TEST_CHECK(try_get_current_context() == ContextId::null());
+    }
+
+    void test_batch_releases_held_context() {
+        test::TestDocument first{ rml_context };
+        ClickElement *element = first.context.create_element<ClickElement>(first.root);
+        first.context.close();
+        test::TestDocument second{ rml_context };
+        second.context.close();
+
+        EventDispatchBatch batch{};
+        click(first.context, element);
+        TEST_CHECK(try_get_current_context() == first.context);
+
+        // Opening another context closes the held one instead of raising an error, which is what the draw hook relies on
+        // for anything that opens contexts in the middle of a batch.
+        second.context.open();
+        TEST_CHECK(try_get_current_context() == second.context);
+        second.context.close();
+
+        // Releasing the held context explicitly leaves nothing open.
+        click(first.context, element);
+        release_event_dispatch_context();
+        TEST_CHECK(try_get_current_context() == ContextId::null());
+        TEST_CHECK(element->clicks == 2);
+    }
+
+    // Routing clicks with no other listeners involved reaches the target and then its ancestors from the bottom up.
+    void test_route_order() {
+        std::vector<std::string> log;
+        test::TestDocument doc{ rml_context };
+        ClickTree tree{ doc, &log };
+
+        click(doc.context, tree.child);
+        TEST_CHECK((log == std::vector<std::string>{ "child", "parent", "grandparent" }));
+    }
+
+    // Change: the target is handled from the document's capture listener, so before capture listeners on its ancestors.
+    // Per-element listeners used to handle it in the target phase, after those capture listeners.
+    void test_target_before_ancestor_capture_listeners() {
+        std::vector<std::string> log;
+        LoggingListener capture_listener{ &log, "rml parent capture" };
+        test::TestDocument doc{ rml_context };
+        ClickTree tree{ doc, &log };
+        test::get_rml_element(doc.context, tree.parent)->AddEventListener(Rml::EventId::Click, &capture_listener, true);
+
+        click(doc.context, tree.child);
+        TEST_CHECK((log == std::vector<std::string>{ "child", "rml parent capture", "parent", "grandparent" }));
+    }
+
+    // Change: ancestors are handled once the event bubbles up to the document, so after every RmlUi bubble listener
+    // between the target and the document. Per-element listeners used to be interleaved with those by depth.
+    void test_ancestors_after_bubble_listeners() {
+        std::vector<std::string> log;
+        LoggingListener bubble_listener{ &log, "rml parent" };
+        test::TestDocument doc{ rml_context };
+        ClickTree tree{ doc, &log };
+        test::get_rml_element(doc.context, tree.parent)->AddEventListener(Rml::EventId::Click, &bubble_listener);
+
+        click(doc.context, tree.child);
+        TEST_CHECK((log == std::vector<std::string>{ "child", "rml parent", "parent", "grandparent" }));
+    }
+
+    // Change: an RmlUi listener that stops propagation hides the event from every ancestor, including the element whose
+    // RmlUi element it's on. That element's own listener used to still run, as listeners on one element all run.
+    void test_bubble_stop_hides_event_from_all_ancestors() {
+        std::vector<std::string> log;
+        LoggingListener stopping_listener{ &log, "rml parent", LoggingListener::Stop::Propagation };
+        test::TestDocument doc{ rml_context };
+        ClickTree tree{ doc, &log };
+        test::get_rml_element(doc.context, tree.parent)->AddEventListener(Rml::EventId::Click, &stopping_listener);
+
+        click(doc.context, tree.child);
+        TEST_CHECK((log == std::vector<std::string>{ "child", "rml parent" }));
+    }
+
+    // Change: stopping propagation in a capture listener below the document no longer hides the event from the target,
+    // which has already handled it by then. The ancestors still don't receive it.
+    void test_capture_stop_still_reaches_target() {
+        std::vector<std::string> log;
+        LoggingListener stopping_listener{ &log, "rml parent capture", LoggingListener::Stop::Immediate };
+        test::TestDocument doc{ rml_context };
+        ClickTree tree{ doc, &log };
+        test::get_rml_element(doc.context, tree.parent)->AddEventListener(Rml::EventId::Click, &stopping_listener, true);
+
+        click(doc.context, tree.child);
+        TEST_CHECK((log == std::vector<std::string>{ "child", "rml parent capture" }));
+    }
+
+    // Unchanged: events that don't bubble, like focus, only reach their target.
+    void test_focus_only_reaches_target() {
+        std::vector<std::string> log;
+        test::TestDocument doc{ rml_context };
+        ClickTree tree{ doc, &log };
+
+        doc.context.open();
+        tree.child->enable_focus();
+        tree.child->focus();
+        doc.context.close();
+        TEST_CHECK((log == std::vector<std::string>{ "child focus" }));
+    }
+
+    // Times a burst of clicks spread over many elements, as the draw hook sees them, with and without a dispatch batch.
+    void run_benchmarks() {
+        constexpr size_t element_count = 200;
+        constexpr size_t events = 20000;
+
+        test::TestDocument doc{ rml_context };
+        std::vector<ClickElement *> elements;
+        std::vector<Rml::Element *> bases;
+        for (size_t i = 0; i < element_count; i++) {
+            elements.emplace_back(doc.context.create_element<ClickElement>(doc.root));
+        }
+        doc.context.close();
+        for (ClickElement *element : elements) {
+            bases.emplace_back(test::get_rml_element(doc.context, element));
+        }
+
+        auto run = [&](const char *name, bool batched) {
+            auto start = std::chrono::steady_clock::now();
+            {
+                std::optional<EventDispatchBatch> batch;
+                if (batched) {
+                    batch.emplace();
+                }
+                for (size_t i = 0; i < events; i++) {
+                    bases[i % element_count]->DispatchEvent(Rml::EventId::Click, Rml::Dictionary{});
+                }
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            TEST_CHECK(try_get_current_context() == ContextId::null());
+            std::printf("%-10s %zu events: %8.1f ns per event\n", name, events,
+                std::chrono::duration<double, std::nano>(elapsed).count() / events);
+        };
+
+        run("unbatched", false);
+        run("batched", true);
+
+        uint32_t clicks = 0;
+        for (ClickElement *element : elements) {
+            clicks += element->clicks;
+        }
+        TEST_CHECK(clicks == 2 * events);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    test::HeadlessRml rml{ "event_tests" };
+    rml_context = rml.context;
+    std::string_view filter = argc > 1 ? argv[1] : "";
+
+    if (filter == "--benchmark") {
+        run_benchmarks();
+        return test::failed_checks == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    return test::run_tests({
+        { "unbatched_dispatch_closes_context", test_unbatched_dispatch_closes_context },
+        { "batch_holds_context", test_batch_holds_context },
+        { "batch_releases_held_context", test_batch_releases_held_context },
+        { "route_order", test_route_order },
+        { "target_before_ancestor_capture_listeners", test_target_before_ancestor_capture_listeners },
+        { "ancestors_after_bubble_listeners", test_ancestors_after_bubble_listeners },
+        { "bubble_stop_hides_event_from_all_ancestors", test_bubble_stop_hides_event_from_all_ancestors },
+        { "capture_stop_still_reaches_target", test_capture_stop_still_reaches_target },
+        { "focus_only_reaches_target", test_focus_only_reaches_target },
+    }, filter);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+
+#include "RmlUi/Core.h"
+
+#include "core/ui_context.h"
+#include "elements/ui_document.h"
+#include "elements/ui_element.h"
+#include "test_common.h"
+
+// Shared setup for the test executables that build recompui documents. RmlUi runs without a window or a GPU, and
+// documents are laid out against a null render interface.
+namespace recompui::test {
+    class NullRenderInterface : public Rml::RenderInterface {
+    public:
+        void RenderGeometry(Rml::Vertex*, int, int*, int, Rml::TextureHandle, const Rml::Vector2f&) override {}
+        void EnableScissorRegion(bool) override {}
+        void SetScissorRegion(int, int, int, int) override {}
+    };
+
+    class TestSystemInterface : public Rml::SystemInterface {
+    public:
+        double GetElapsedTime() override {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        }
+    private:
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    };
+
+    // Initializes RmlUi with a single 1080p context for as long as it's alive.
+    class HeadlessRml {
+    public:
+        HeadlessRml(const char *context_name) : context_name(context_name) {
+            Rml::SetRenderInterface(&render_interface);
+            Rml::SetSystemInterface(&system_interface);
+            Rml::Initialise();
+            context = Rml::CreateContext(context_name, Rml::Vector2i{ 1920, 1080 });
+        }
+
+        ~HeadlessRml() {
+            Rml::RemoveContext(context_name);
+            Rml::Shutdown();
+        }
+
+        HeadlessRml(const HeadlessRml&) = delete;
+        HeadlessRml& operator=(const HeadlessRml&) = delete;
+
+        Rml::Context *context = nullptr;
+    private:
+        const char *context_name;
+        NullRenderInterface render_interface;
+        TestSystemInterface system_interface;
+    };
+
+    // Gets the Rml element backing an element by its id, as the element's own pointer to it isn't public.
+    inline Rml::Element *get_rml_element(ContextId context, Element *element) {
+        return context.get_document()->GetElementById(element->get_id());
+    }
+
+    // A document in the test RmlUi context with its own recompui context, which is left open so the test can start
+    // creating elements right away.
+    class TestDocument {
+    public:
+        TestDocument(Rml::Context *rml_context) : rml_context(rml_context) {
+            Rml::ElementDocument *document = rml_context->CreateDocument();
+            context = create_context(document);
+            root = context.get_root_element();
+            document->Show();
+            context.open();
+        }
+
+        // Destroying the context also removes its document from the RmlUi context, so it isn't unloaded here.
+        ~TestDocument() {
+            if (try_get_current_context() == context) {
+                context.close();
+            }
+            destroy_context(context);
+            TEST_CHECK(!context.exists());
+            rml_context->Update();
+        }
+
+        TestDocument(const TestDocument&) = delete;
+        TestDocument& operator=(const TestDocument&) = delete;
+
+        // Runs the same per-frame work as the UI's draw hook. Expects the context to be closed.
+        void run_frame() {
+            context.open();
+            context.process_animations();
+            context.process_data_bindings();
+            context.process_updates();
+            context.close();
+            bool layout_changed = context.take_layout_changes();
+            rml_context->Update();
+            if (layout_changed) {
+                context.invalidate_layout();
+            }
+        }
+
+        ContextId context;
+        Document *root;
+    protected:
+        Rml::Context *rml_context;
+    };
+} // namespace recompui::test
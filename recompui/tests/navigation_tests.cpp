@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/ui_context.h"
+#include "elements/ui_element.h"
+#include "elements/ui_document.h"
+#include "headless_ui.h"
+#include "test_common.h"
+
+using namespace recompui;
+
+namespace {
+    // A directional input and the element that should be focused after it's handled.
+    struct NavStep {
+        Rml::Input::KeyIdentifier key;
+        Element *expected;
+    };
+
+    const char *get_key_name(Rml::Input::KeyIdentifier key) {
+        switch (key) {
+            case Rml::Input::KI_UP:    return "Up";
+            case Rml::Input::KI_DOWN:  return "Down";
+            case Rml::Input::KI_LEFT:  return "Left";
+            case Rml::Input::KI_RIGHT: return "Right";
+            default:                   return "?";
+        }
+    }
+
+    // Navigation time of every move made by the tests, reported once all of them have run.
+    std::vector<std::chrono::nanoseconds> move_times;
+
+    // A test document with helpers for building navigation trees. Elements are laid out with fixed sizes, as no
+    // fonts are loaded. Items are spaced further apart than their size, as the spatial navigation measures the distance
+    // along the other axis between opposite edges, which would otherwise make diagonal neighbours as close as aligned ones.
+    class NavTestDocument : public test::TestDocument {
+    public:
+        NavTestDocument(Rml::Context *rml_context) : TestDocument(rml_context) {}
+
+        // Creates a flex container, which is also a navigation container unless no navigation type is given.
+        Element *add_container(Element *parent, FlexDirection direction, std::optional<NavigationType> nav_type) {
+            Element *ret = context.create_element<Element>(parent);
+            ret->set_display(Display::Flex);
+            ret->set_flex_direction(direction);
+            if (nav_type.has_value()) {
+                ret->set_as_navigation_container(nav_type.value());
+            }
+            return ret;
+        }
+
+        Element *add_item(Element *parent, const std::string &debug_id) {
+            Element *ret = context.create_element<Element>(parent);
+            ret->set_display(Display::Block);
+            ret->set_width(item_size, Unit::Px);
+            ret->set_height(item_size, Unit::Px);
+            ret->set_margin(item_margin, Unit::Px);
+            ret->enable_focus();
+            ret->set_debug_id(debug_id);
+            return ret;
+        }
+
+        // Finishes building the tree and lays it out, then focuses the starting element.
+        void start(Element *focused) {
+            context.close();
+            run_frame();
+
+            context.open();
+            focused->focus();
+            context.close();
+            run_frame();
+        }
+
+        Element *get_focused() {
+            context.open();
+            Element *ret = context.get_focused_element();
+            context.close();
+            return ret;
+        }
+
+        // Sends each input and checks the focused element after it, recording how long the document took to handle it.
+        void run_steps(const std::vector<NavStep> &steps, bool run_frames = true) {
+            for (size_t i = 0; i < steps.size(); i++) {
+                const NavStep &step = steps[i];
+                rml_context->ProcessKeyDown(step.key, 0);
+                rml_context->ProcessKeyUp(step.key, 0);
+                move_times.emplace_back(root->get_navigation_stats().last_move_time);
+
+                Element *focused = get_focused();
+                if (focused != step.expected) {
+                    std::fprintf(stderr, "step %zu (%s): expected %s, focused %s\n", i, get_key_name(step.key),
+                        step.expected->get_debug_id().c_str(), focused == nullptr ? "nothing" : focused->get_debug_id().c_str());
+                }
+                TEST_CHECK(focused == step.expected);
+
+                if (run_frames) {
+                    run_frame();
+                }
+            }
+        }
+
+        static constexpr float item_size = 10.0f;
+        static constexpr float item_margin = 10.0f;
+    };
+
+    Rml::Context *rml_context = nullptr;
+
+    constexpr Rml::Input::KeyIdentifier up = Rml::Input::KI_UP;
+    constexpr Rml::Input::KeyIdentifier down = Rml::Input::KI_DOWN;
+    constexpr Rml::Input::KeyIdentifier left = Rml::Input::KI_LEFT;
+    constexpr Rml::Input::KeyIdentifier right = Rml::Input::KI_RIGHT;
+
+    void test_vertical() {
+        NavTestDocument doc{ rml_context };
+        Element *list = doc.add_container(doc.root, FlexDirection::Column, NavigationType::Vertical);
+        Element *a = doc.add_item(list, "a");
+        Element *b = doc.add_item(list, "b");
+        Element *c = doc.add_item(list, "c");
+        doc.start(a);
+
+        // Inputs past the ends of the list or across it keep the focus where it is.
+        doc.run_steps({
+            { down, b }, { down, c }, { down, c }, { up, b }, { up, a }, { up, a },
+            { left, a }, { right, a },
+        });
+    }
+
+    void test_vertical_wrapping() {
+        NavTestDocument doc{ rml_context };
+        Element *list = doc.add_container(doc.root, FlexDirection::Column, NavigationType::Vertical);
+        list->set_nav_wrapping(true);
+        Element *a = doc.add_item(list, "a");
+        Element *b = doc.add_item(list, "b");
+        Element *c = doc.add_item(list, "c");
+        doc.start(a);
+
+        doc.run_steps({ { up, c }, { down, a }, { down, b } });
+    }
+
+    void test_horizontal() {
+        NavTestDocument doc{ rml_context };
+        Element *list = doc.add_container(doc.root, FlexDirection::Row, NavigationType::Horizontal);
+        Element *a = doc.add_item(list, "a");
+        Element *b = doc.add_item(list, "b");
+        Element *c = doc.add_item(list, "c");
+        doc.start(a);
+
+        doc.run_steps({
+            { right, b }, { right, c }, { right, c }, { left, b }, { left, a }, { left, a },
+            { up, a }, { down, a },
+        });
+    }
+
+    void test_nested_lists() {
+        // A vertical list of horizontal rows. Moving between rows picks the row's primary focus.
+        NavTestDocument doc{ rml_context };
+        Element *list = doc.add_container(doc.root, FlexDirection::Column, NavigationType::Vertical);
+        Element *row0 = doc.add_container(list, FlexDirection::Row, NavigationType::Horizontal);
+        Element *a0 = doc.add_item(row0, "a0");
+        Element *a1 = doc.add_item(row0, "a1");
+        a1->set_as_primary_focus();
+        Element *row1 = doc.add_container(list, FlexDirection::Row, NavigationType::Horizontal);
+        Element *b0 = doc.add_item(row1, "b0");
+        Element *b1 = doc.add_item(row1, "b1");
+        b1->set_as_primary_focus();
+        doc.start(a0);
+
+        doc.run_steps({ { down, b1 }, { left, b0 }, { up, a1 }, { left, a0 }, { right, a1 } });
+    }
+
+    void test_auto() {
+        // Elements in an automatic container are picked by position. The container holds a 2x2 grid made of two plain
+        // rows, which aren't navigation containers themselves.
+        NavTestDocument doc{ rml_context };
+        Element *container = doc.add_container(doc.root, FlexDirection::Column, NavigationType::Auto);
+        Element *row0 = doc.add_container(container, FlexDirection::Row, std::nullopt);
+        Element *a = doc.add_item(row0, "a");
+        Element *b = doc.add_item(row0, "b");
+        Element *row1 = doc.add_container(container, FlexDirection::Row, std::nullopt);
+        Element *c = doc.add_item(row1, "c");
+        Element *d = doc.add_item(row1, "d");
+        doc.start(a);
+
+        doc.run_steps({ { right, b }, { down, d }, { left, c }, { up, a }, { left, a }, { down, c }, { right, d } });
+    }
+
+    void test_grid() {
+        // Rows in a GridCol keep the column index when moving between rows, clamped to the length of the shorter row.
+        NavTestDocument doc{ rml_context };
+        Element *grid = doc.add_container(doc.root, FlexDirection::Column, NavigationType::GridCol);
+        std::vector<std::vector<Element *>> cells;
+        size_t row_lengths[] = { 3, 3, 2 };
+        for (size_t row = 0; row < std::size(row_lengths); row++) {
+            Element *row_element = doc.add_container(grid, FlexDirection::Row, NavigationType::GridRow);
+            cells.emplace_back();
+            for (size_t col = 0; col < row_lengths[row]; col++) {
+                cells.back().emplace_back(doc.add_item(row_element, "r" + std::to_string(row) + "c" + std::to_string(col)));
+            }
+        }
+        doc.start(cells[0][2]);
+
+        doc.run_steps({
+            { down, cells[1][2] }, { down, cells[2][1] }, { up, cells[1][1] }, { left, cells[1][0] },
+            { up, cells[0][0] }, { right, cells[0][1] }, { up, cells[0][1] },
+        });
+    }
+
+    void test_none() {
+        // A container with no navigation type passes inputs through to its parent, so the document's vertical list
+        // moves between the containers around it. Entering the container picks its primary focus.
+        NavTestDocument doc{ rml_context };
+        Element *top = doc.add_container(doc.root, FlexDirection::Column, NavigationType::Vertical);
+        Element *a = doc.add_item(top, "a");
+        Element *middle = doc.add_container(doc.root, FlexDirection::Row, NavigationType::None);
+        doc.add_item(middle, "b");
+        Element *c = doc.add_item(middle, "c");
+        c->set_as_primary_focus();
+        Element *bottom = doc.add_container(doc.root, FlexDirection::Column, NavigationType::Vertical);
+        Element *d = doc.add_item(bottom, "d");
+        doc.start(a);
+
+        doc.run_steps({ { down, c }, { left, c }, { right, c }, { down, d }, { up, c }, { up, a } });
+    }
+
+    void test_large_auto_grid() {
+        // Moves through a large automatic container without running frames in between, which should reuse the cached
+        // navigation tree and spatial index for every move.
+        constexpr size_t grid_size = 32;
+        constexpr size_t moves = 20;
+        constexpr float pitch = NavTestDocument::item_size + 2 * NavTestDocument::item_margin;
+
+        NavTestDocument doc{ rml_context };
+        Element *container = doc.add_container(doc.root, FlexDirection::Row, NavigationType::Auto);
+        container->set_flex_wrap(FlexWrap::Wrap);
+        container->set_width(grid_size * pitch, Unit::Px);
+        std::vector<Element *> cells;
+        for (size_t i = 0; i < grid_size * grid_size; i++) {
+            cells.emplace_back(doc.add_item(container, "cell" + std::to_string(i)));
+        }
+        doc.start(cells[0]);
+        doc.root->reset_navigation_stats();
+
+        std::vector<NavStep> steps;
+        for (size_t i = 1; i <= moves; i++) {
+            steps.emplace_back(NavStep{ right, cells[i] });
+        }
+        for (size_t i = 1; i <= moves; i++) {
+            steps.emplace_back(NavStep{ down, cells[i * grid_size + moves] });
+        }
+        doc.run_steps(steps, false);
+
+        const NavigationStats &stats = doc.root->get_navigation_stats();
+        TEST_CHECK(stats.moves == moves * 2);
+        TEST_CHECK(stats.failed_moves == 0);
+        TEST_CHECK(stats.tree_rebuilds <= 1);
+        TEST_CHECK(stats.spatial_index_builds <= 1);
+        // Generous enough for debug builds, but catches navigation that scales badly with the number of elements.
+        TEST_CHECK(stats.max_move_time < std::chrono::milliseconds{50});
+    }
+
+    void test_spatial_index_reused_across_frames() {
+        // Frames where nothing changed don't invalidate the layout, so the spatial index built for one move is reused by
+        // later moves no matter how many frames ran in between.
+        constexpr size_t grid_size = 8;
+        constexpr size_t idle_frames = 10;
+        constexpr float pitch = NavTestDocument::item_size + 2 * NavTestDocument::item_margin;
+
+        NavTestDocument doc{ rml_context };
+        Element *container = doc.add_container(doc.root, FlexDirection::Row, NavigationType::Auto);
+        container->set_flex_wrap(FlexWrap::Wrap);
+        container->set_width(grid_size * pitch, Unit::Px);
+        std::vector<Element *> cells;
+        for (size_t i = 0; i < grid_size * grid_size; i++) {
+            cells.emplace_back(doc.add_item(container, "cell" + std::to_string(i)));
+        }
+        doc.start(cells[0]);
+        doc.run_frame();
+        doc.root->reset_navigation_stats();
+
+        uint32_t generation = doc.context.get_layout_generation();
+        for (size_t i = 0; i < idle_frames; i++) {
+            doc.run_frame();
+        }
+        TEST_CHECK(doc.context.get_layout_generation() == generation);
+
+        // A focus change can restyle the elements involved, so the frame after a move is laid out again, but only once.
+        doc.run_steps({ { right, cells[1] } }, false);
+        TEST_CHECK(doc.root->get_navigation_stats().spatial_index_builds == 1);
+        for (size_t i = 0; i < idle_frames; i++) {
+            doc.run_frame();
+        }
+        TEST_CHECK(doc.context.get_layout_generation() == generation + 1);
+
+        doc.run_steps({ { down, cells[grid_size + 1] }, { right, cells[grid_size + 2] } }, false);
+        const NavigationStats &stats = doc.root->get_navigation_stats();
+        std::printf("%zu frames, %u moves: %u spatial index builds\n", 2 * idle_frames + 2, stats.moves, stats.spatial_index_builds);
+        TEST_CHECK(stats.spatial_index_builds == 2);
+
+        // Changing a property lays the document out again.
+        generation = doc.context.get_layout_generation();
+        doc.run_frame();
+        doc.context.open();
+        cells[0]->set_margin(2 * NavTestDocument::item_margin, Unit::Px);
+        doc.context.close();
+        doc.run_frame();
+        TEST_CHECK(doc.context.get_layout_generation() == generation + 2);
+    }
+
+    // Times moves through a 2000 element automatic container, once reusing the cached navigation tree and spatial index
+    // and once with both invalidated before every move, as happens when the document changes between inputs.
+    void run_benchmarks() {
+        constexpr size_t columns = 50;
+        constexpr size_t rows = 40;
+        constexpr size_t moves = 200;
+        constexpr float pitch = NavTestDocument::item_size + 2 * NavTestDocument::item_margin;
+
+        NavTestDocument doc{ rml_context };
+        Element *container = doc.add_container(doc.root, FlexDirection::Row, NavigationType::Auto);
+        container->set_flex_wrap(FlexWrap::Wrap);
+        container->set_width(columns * pitch, Unit::Px);
+        std::vector<Element *> cells;
+        for (size_t i = 0; i < columns * rows; i++) {
+            cells.emplace_back(doc.add_item(container, "cell" + std::to_string(i)));
+        }
+        doc.start(cells[0]);
+
+        auto run = [&](const char *name, bool invalidate) {
+            doc.root->reset_navigation_stats();
+            std::vector<std::chrono::nanoseconds> times;
+            for (size_t i = 0; i < moves; i++) {
+                if (invalidate) {
+                    doc.context.invalidate_navigation();
+                    doc.context.invalidate_layout();
+                }
+                // Sweep back and forth across the first row so every move succeeds.
+                Rml::Input::KeyIdentifier key = (i / (columns - 1)) % 2 == 0 ? right : left;
+                rml_context->ProcessKeyDown(key, 0);
+                rml_context->ProcessKeyUp(key, 0);
+                times.emplace_back(doc.root->get_navigation_stats().last_move_time);
+            }
+
+            const NavigationStats &stats = doc.root->get_navigation_stats();
+            TEST_CHECK(stats.failed_moves == 0);
+            std::sort(times.begin(), times.end());
+            auto to_us = [](std::chrono::nanoseconds time) { return std::chrono::duration<double, std::micro>(time).count(); };
+            std::printf("%-10s %zu elements, %u moves: median %8.1f us, max %8.1f us, %u tree rebuilds, %u spatial index builds\n",
+                name, cells.size(), stats.moves, to_us(times[times.size() / 2]), to_us(times.back()), stats.tree_rebuilds,
+                stats.spatial_index_builds);
+        };
+
+        run("cached", false);
+        run("uncached", true);
+    }
+
+    void report_move_times() {
+        if (move_times.empty()) {
+            return;
+        }
+
+        std::sort(move_times.begin(), move_times.end());
+        auto to_us = [](std::chrono::nanoseconds time) { return std::chrono::duration<double, std::micro>(time).count(); };
+        std::printf("%zu moves: median %.1f us, p99 %.1f us, max %.1f us\n", move_times.size(),
+            to_us(move_times[move_times.size() / 2]), to_us(move_times[move_times.size() * 99 / 100]), to_us(move_times.back()));
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    test::HeadlessRml rml{ "navigation_tests" };
+    rml_context = rml.context;
+    std::string_view filter = argc > 1 ? argv[1] : "";
+
+    if (filter == "--benchmark") {
+        run_benchmarks();
+        return test::failed_checks == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int ret = test::run_tests({
+        { "vertical", test_vertical },
+        { "vertical_wrapping", test_vertical_wrapping },
+        { "horizontal", test_horizontal },
+        { "nested_lists", test_nested_lists },
+        { "auto", test_auto },
+        { "grid", test_grid },
+        { "none", test_none },
+        { "large_auto_grid", test_large_auto_grid },
+        { "spatial_index_reused_across_frames", test_spatial_index_reused_across_frames },
+    }, filter);
+    report_move_times();
+
+    return ret;
+}
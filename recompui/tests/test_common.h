@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Minimal test harness shared by the recompui test executables. Each test is a function that reports failures through
+// TEST_CHECK, and main returns a nonzero exit code if any check failed so CTest marks the test as failed.
+namespace recompui::test {
+    struct TestCase {
+        const char *name;
+        std::function<void()> func;
+    };
+
+    inline int failed_checks = 0;
+
+    inline void report_failure(const char *file, int line, const char *expression) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        failed_checks++;
+    }
+
+    // Runs every test, or only the tests whose name contains the filter if one is given.
+    inline int run_tests(const std::vector<TestCase> &tests, std::string_view filter) {
+        int failed_tests = 0;
+        for (const TestCase &test : tests) {
+            if (!filter.empty() && std::string_view{ test.name }.find(filter) == std::string_view::npos) {
+                continue;
+            }
+
+            int prev_failed_checks = failed_checks;
+            test.func();
+            bool passed = failed_checks == prev_failed_checks;
+            std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", test.name);
+            if (!passed) {
+                failed_tests++;
+            }
+        }
+
+        return failed_tests == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+} // namespace recompui::test
+
+#define TEST_CHECK(expression) \
+    do { \
+        if (!(expression)) { \
+            recompui::test::report_failure(__FILE__, __LINE__, #expression); \
+        } \
+    } while (0)
@@ -0,0 +1,346 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+#include "recomp.h"
+#include "rdram_copy.h"
+#include "ui_key_repeat.h"
+#include "test_common.h"
+
+using namespace recompui;
+
+namespace {
+    constexpr gpr rdram_base = 0xFFFFFFFF80000000ULL;
+    // Space left around every tested range so writes outside of it can be detected.
+    constexpr size_t guard_size = 16;
+
+    // Covers every combination of head and tail alignment, along with ranges long enough to use the vectorized path.
+    const std::vector<size_t> &get_test_lengths() {
+        static std::vector<size_t> lengths = []() {
+            std::vector<size_t> ret;
+            for (size_t i = 0; i <= 68; i++) {
+                ret.emplace_back(i);
+            }
+            for (size_t i : { 127, 128, 129, 130, 1021, 1022, 1023, 1024, 4099 }) {
+                ret.emplace_back(i);
+            }
+            return ret;
+        }();
+        return lengths;
+    }
+
+    uint8_t pattern_byte(size_t index) {
+        return uint8_t((index * 167 + 13) ^ (index >> 8));
+    }
+
+    void test_copy_from_rdram() {
+        std::vector<uint8_t> rdram_bytes(8192 + 2 * guard_size);
+        uint8_t* rdram = rdram_bytes.data();
+        for (size_t i = 0; i < rdram_bytes.size(); i++) {
+            rdram[i] = pattern_byte(i);
+        }
+
+        for (size_t head = 0; head < 4; head++) {
+            gpr addr = rdram_base + guard_size + head;
+            for (size_t length : get_test_lengths()) {
+                std::vector<uint8_t> expected(length + guard_size, 0xCD);
+                for (size_t i = 0; i < length; i++) {
+                    expected[i] = MEM_BU(i, addr);
+                }
+
+                std::vector<uint8_t> actual(length + guard_size, 0xCD);
+                copy_from_rdram(rdram, actual.data(), addr, length);
+                TEST_CHECK(actual == expected);
+            }
+        }
+    }
+
+    void test_copy_to_rdram() {
+        std::vector<uint8_t> src(get_test_lengths().back());
+        for (size_t i = 0; i < src.size(); i++) {
+            src[i] = pattern_byte(i);
+        }
+
+        for (size_t head = 0; head < 4; head++) {
+            gpr addr = rdram_base + guard_size + head;
+            for (size_t length : get_test_lengths()) {
+                // Write the same bytes with a MEM_B loop into one copy of rdram and with copy_to_rdram into the other,
+                // then compare all of rdram so bytes outside of the range are checked too.
+                std::vector<uint8_t> expected_rdram(8192 + 2 * guard_size, 0xEE);
+                {
+                    uint8_t* rdram = expected_rdram.data();
+                    for (size_t i = 0; i < length; i++) {
+                        MEM_B(i, addr) = int8_t(src[i]);
+                    }
+                }
+
+                std::vector<uint8_t> actual_rdram(8192 + 2 * guard_size, 0xEE);
+                copy_to_rdram(actual_rdram.data(), addr, src.data(), length);
+                TEST_CHECK(actual_rdram == expected_rdram);
+            }
+        }
+    }
+
+    void test_rdram_strlen() {
+        for (size_t head = 0; head < 4; head++) {
+            gpr addr = rdram_base + guard_size + head;
+            for (size_t length : get_test_lengths()) {
+                // Fill everything with non-zero bytes so only the terminator can end the string.
+                std::vector<uint8_t> rdram_bytes(8192 + 2 * guard_size);
+                uint8_t* rdram = rdram_bytes.data();
+                for (size_t i = 0; i < rdram_bytes.size(); i++) {
+                    rdram[i] = pattern_byte(i) | 0x01;
+                }
+                MEM_B(length, addr) = 0;
+
+                size_t expected = 0;
+                while (MEM_B(expected, addr) != 0) {
+                    expected++;
+                }
+
+                TEST_CHECK(expected == length);
+                TEST_CHECK(rdram_strlen(rdram, addr) == expected);
+            }
+        }
+    }
+
+    // Drives a KeyRepeatScheduler with a clock that only moves when the test advances it.
+    struct FakeClock {
+        KeyRepeatScheduler::clock::time_point time = KeyRepeatScheduler::clock::time_point{ std::chrono::hours{1} };
+
+        void advance(std::chrono::milliseconds amount) {
+            time += amount;
+        }
+
+        KeyRepeatScheduler make_scheduler(const KeyRepeatScheduler::Settings &settings = KeyRepeatScheduler::Settings{}) {
+            return KeyRepeatScheduler{ settings, [this]() { return time; } };
+        }
+    };
+
+    std::vector<int> poll_keys(KeyRepeatScheduler &scheduler) {
+        std::vector<int> keys;
+        scheduler.poll([&keys](int key) { keys.emplace_back(key); });
+        return keys;
+    }
+
+    constexpr int key_a = 1;
+    constexpr int key_b = 2;
+
+    void test_key_repeat_start_delay() {
+        FakeClock clock;
+        KeyRepeatScheduler scheduler = clock.make_scheduler();
+
+        scheduler.press(0, key_a);
+        clock.advance(std::chrono::milliseconds{499});
+        TEST_CHECK(poll_keys(scheduler).empty());
+        clock.advance(std::chrono::milliseconds{1});
+        TEST_CHECK(poll_keys(scheduler) == std::vector<int>{ key_a });
+        clock.advance(std::chrono::milliseconds{49});
+        TEST_CHECK(poll_keys(scheduler).empty());
+        clock.advance(std::chrono::milliseconds{1});
+        TEST_CHECK(poll_keys(scheduler) == std::vector<int>{ key_a });
+
+        scheduler.release(0, key_a);
+        TEST_CHECK(!scheduler.is_repeating());
+        clock.advance(std::chrono::milliseconds{1000});
+        TEST_CHECK(poll_keys(scheduler).empty());
+    }
+
+    void test_key_repeat_frame_rate_independent() {
+        // The number of repeats only depends on how long the key was held, not on how often the scheduler is polled.
+        size_t counts[2];
+        int poll_intervals[2] = { 1, 33 };
+        for (size_t i = 0; i < 2; i++) {
+            FakeClock clock;
+            KeyRepeatScheduler scheduler = clock.make_scheduler();
+            scheduler.press(0, key_a);
+
+            // Poll at the given interval, then once more exactly at the end so both runs cover the same time.
+            counts[i] = 0;
+            int elapsed = 0;
+            while (elapsed + poll_intervals[i] <= 3000) {
+                clock.advance(std::chrono::milliseconds{ poll_intervals[i] });
+                elapsed += poll_intervals[i];
+                counts[i] += poll_keys(scheduler).size();
+            }
+            clock.advance(std::chrono::milliseconds{ 3000 - elapsed });
+            counts[i] += poll_keys(scheduler).size();
+        }
+
+        TEST_CHECK(counts[0] > 0);
+        TEST_CHECK(counts[0] == counts[1]);
+    }
+
+    void test_key_repeat_latest_key_wins() {
+        FakeClock clock;
+        KeyRepeatScheduler scheduler = clock.make_scheduler();
+
+        scheduler.press(0, key_a);
+        clock.advance(std::chrono::milliseconds{100});
+        scheduler.press(0, key_b);
+
+        // Only the newer key repeats, starting from when it was pressed.
+        clock.advance(std::chrono::milliseconds{600});
+        TEST_CHECK((poll_keys(scheduler) == std::vector<int>{ key_b, key_b, key_b }));
+
+        // Releasing the older key doesn't stop the newer one.
+        scheduler.release(0, key_a);
+        clock.advance(std::chrono::milliseconds{50});
+        TEST_CHECK(poll_keys(scheduler) == std::vector<int>{ key_b });
+
+        scheduler.release(0, key_b);
+        clock.advance(std::chrono::milliseconds{1000});
+        TEST_CHECK(poll_keys(scheduler).empty());
+    }
+
+    void test_key_repeat_devices() {
+        FakeClock clock;
+        KeyRepeatScheduler scheduler = clock.make_scheduler();
+
+        scheduler.press(0, key_a);
+        clock.advance(std::chrono::milliseconds{10});
+        scheduler.press(1, key_b);
+
+        // Repeats from both devices are sent in the order they were due.
+        clock.advance(std::chrono::milliseconds{540});
+        TEST_CHECK((poll_keys(scheduler) == std::vector<int>{ key_a, key_b, key_a }));
+
+        scheduler.release_device(0);
+        clock.advance(std::chrono::milliseconds{50});
+        TEST_CHECK(poll_keys(scheduler) == std::vector<int>{ key_b });
+
+        scheduler.release_all();
+        TEST_CHECK(!scheduler.is_repeating());
+        clock.advance(std::chrono::milliseconds{1000});
+        TEST_CHECK(poll_keys(scheduler).empty());
+    }
+
+    void test_key_repeat_catch_up_limit() {
+        FakeClock clock;
+        KeyRepeatScheduler::Settings settings{};
+        KeyRepeatScheduler scheduler = clock.make_scheduler(settings);
+
+        scheduler.press(0, key_a);
+        clock.advance(std::chrono::milliseconds{500});
+        TEST_CHECK(poll_keys(scheduler).size() == 1);
+
+        // A long stall only sends a few repeats instead of every one that was missed.
+        clock.advance(std::chrono::milliseconds{10000});
+        size_t repeats = poll_keys(scheduler).size();
+        TEST_CHECK(repeats > 0);
+        TEST_CHECK(repeats <= settings.max_catch_up_repeats + 1);
+    }
+
+    void test_key_repeat_acceleration() {
+        FakeClock clock;
+        KeyRepeatScheduler::Settings settings{};
+        KeyRepeatScheduler scheduler = clock.make_scheduler(settings);
+        scheduler.press(0, key_a);
+
+        std::vector<KeyRepeatScheduler::clock::time_point> repeat_times;
+        for (int elapsed = 0; elapsed < 6000; elapsed++) {
+            clock.advance(std::chrono::milliseconds{1});
+            scheduler.poll([&](int) { repeat_times.emplace_back(clock.time); });
+        }
+
+        TEST_CHECK(repeat_times.size() > 2);
+        if (repeat_times.size() > 2) {
+            TEST_CHECK(repeat_times[1] - repeat_times[0] == settings.repeat_rate);
+            TEST_CHECK(repeat_times.back() - repeat_times[repeat_times.size() - 2] == settings.fastest_repeat_rate);
+        }
+    }
+
+    // Compares the bulk copies against the MEM_B loops they replace. Not run by default, as the results depend on the machine.
+    void run_benchmarks() {
+        using bench_clock = std::chrono::steady_clock;
+        constexpr size_t size = 1024 * 1024;
+        constexpr int iterations = 200;
+
+        std::vector<uint8_t> rdram_bytes(size + 2 * guard_size);
+        uint8_t* rdram = rdram_bytes.data();
+        for (size_t i = 0; i < rdram_bytes.size(); i++) {
+            rdram[i] = pattern_byte(i) | 0x01;
+        }
+        std::vector<uint8_t> host(size);
+        gpr addr = rdram_base + guard_size + 1;
+        uint64_t checksum = 0;
+
+        auto report = [](const char *name, bench_clock::duration elapsed) {
+            double seconds = std::chrono::duration<double>(elapsed).count();
+            std::printf("%-28s %10.1f MB/s\n", name, double(size) * iterations / seconds / (1024.0 * 1024.0));
+        };
+
+        bench_clock::time_point start = bench_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            for (size_t i = 0; i < size; i++) {
+                host[i] = MEM_BU(i, addr);
+            }
+            checksum += host[iteration];
+        }
+        report("MEM_B loop (read)", bench_clock::now() - start);
+
+        start = bench_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            copy_from_rdram(rdram, host.data(), addr, size);
+            checksum += host[iteration];
+        }
+        report("copy_from_rdram", bench_clock::now() - start);
+
+        start = bench_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            for (size_t i = 0; i < size; i++) {
+                MEM_B(i, addr) = int8_t(host[i]);
+            }
+            checksum += rdram[iteration];
+        }
+        report("MEM_B loop (write)", bench_clock::now() - start);
+
+        start = bench_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            copy_to_rdram(rdram, addr, host.data(), size);
+            checksum += rdram[iteration];
+        }
+        report("copy_to_rdram", bench_clock::now() - start);
+
+        MEM_B(size - 1, addr) = 0;
+        start = bench_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            size_t length = 0;
+            while (MEM_B(length, addr) != 0) {
+                length++;
+            }
+            checksum += length;
+        }
+        report("MEM_B loop (strlen)", bench_clock::now() - start);
+
+        start = bench_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            checksum += rdram_strlen(rdram, addr);
+        }
+        report("rdram_strlen", bench_clock::now() - start);
+
+        std::printf("checksum: %llu\n", (unsigned long long)checksum);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string_view filter = argc > 1 ? argv[1] : "";
+    if (filter == "--benchmark") {
+        run_benchmarks();
+        return EXIT_SUCCESS;
+    }
+
+    return test::run_tests({
+        { "copy_from_rdram", test_copy_from_rdram },
+        { "copy_to_rdram", test_copy_to_rdram },
+        { "rdram_strlen", test_rdram_strlen },
+        { "key_repeat_start_delay", test_key_repeat_start_delay },
+        { "key_repeat_frame_rate_independent", test_key_repeat_frame_rate_independent },
+        { "key_repeat_latest_key_wins", test_key_repeat_latest_key_wins },
+        { "key_repeat_devices", test_key_repeat_devices },
+        { "key_repeat_catch_up_limit", test_key_repeat_catch_up_limit },
+        { "key_repeat_acceleration", test_key_repeat_acceleration },
+    }, filter);
+}
@@ -0,0 +1,136 @@
+#include <string_view>
+#include <unordered_map>
+
+#include "core/ui_context.h"
+#include "elements/ui_element.h"
+#include "elements/ui_document.h"
+#include "elements/ui_virtual_list.h"
+#include "headless_ui.h"
+#include "test_common.h"
+
+using namespace recompui;
+
+namespace {
+    Rml::Context *rml_context = nullptr;
+
+    constexpr float row_height = 50.0f;
+    constexpr float viewport_height = 500.0f;
+    constexpr uint32_t overscan = 2;
+    // Most rows the list can need at once, which is when the viewport cuts off a row at both ends.
+    constexpr uint32_t max_rows = static_cast<uint32_t>(viewport_height / row_height) + 1 + overscan * 2;
+
+    // A virtual list in a fixed size viewport that counts the rows it creates and tracks which item each row is bound to.
+    class ListDocument : public test::TestDocument {
+    public:
+        ListDocument(Rml::Context *rml_context, size_t item_count) : TestDocument(rml_context) {
+            Element *viewport = context.create_element<Element>(root);
+            viewport->set_display(Display::Block);
+            viewport->set_width(400.0f, Unit::Px);
+            viewport->set_height(viewport_height, Unit::Px);
+
+            list = context.create_element<VirtualList>(viewport, row_height,
+                [this](ContextId row_context, Element *parent) {
+                    rows_created++;
+                    return row_context.create_element<Element>(parent);
+                },
+                [this](Element *row, size_t index) {
+                    bound_items[row] = index;
+                }
+            );
+            list->set_overscan(overscan);
+            list->set_item_count(item_count);
+            context.close();
+
+            // The first frame lays out the list and the second one creates the rows for it.
+            run_frame();
+            run_frame();
+        }
+
+        void scroll_to(float scroll_top) {
+            test::get_rml_element(context, list)->SetScrollTop(scroll_top);
+        }
+
+        // Checks that exactly the items in [first, last) have rows and that each row is bound to its item.
+        void check_rows(size_t first, size_t last) {
+            for (size_t index = 0; index < list->get_item_count(); index++) {
+                Element *row = list->get_row(index);
+                bool in_range = index >= first && index < last;
+                TEST_CHECK((row != nullptr) == in_range);
+                if (row != nullptr) {
+                    TEST_CHECK(bound_items[row] == index);
+                }
+            }
+        }
+
+        VirtualList *list;
+        uint32_t rows_created = 0;
+        std::unordered_map<Element *, size_t> bound_items;
+    };
+
+    void test_rows_cover_viewport() {
+        ListDocument doc{ rml_context, 1000 };
+
+        // Ten visible rows and the overscan below them, as there's nothing above the first row.
+        doc.check_rows(0, 10 + overscan);
+        TEST_CHECK(doc.rows_created == 10 + overscan);
+    }
+
+    void test_scroll_updates_rows_immediately() {
+        ListDocument doc{ rml_context, 1000 };
+
+        // The rows are in place as soon as the scroll event is handled, without waiting for another frame.
+        doc.scroll_to(40 * row_height);
+        doc.check_rows(40 - overscan, 50 + overscan);
+
+        // The rows that scrolled out of range were rebound, so only the extra overscan rows above are new.
+        TEST_CHECK(doc.rows_created == 10 + overscan * 2);
+    }
+
+    void test_rows_recycled_while_scrolling() {
+        ListDocument doc{ rml_context, 1000 };
+
+        // Scroll through the whole list in steps that don't line up with the rows.
+        float scroll_top = 0.0f;
+        for (uint32_t step = 0; step < 1200; step++) {
+            scroll_top += row_height * 0.9f;
+            doc.scroll_to(scroll_top);
+            doc.run_frame();
+        }
+
+        TEST_CHECK(doc.rows_created <= max_rows);
+
+        // The list is scrolled to the bottom, so only the overscan is above the visible rows.
+        doc.check_rows(1000 - 10 - overscan, 1000);
+    }
+
+    void test_item_count_change_releases_rows() {
+        ListDocument doc{ rml_context, 1000 };
+
+        doc.context.open();
+        doc.list->set_item_count(5);
+        doc.context.close();
+        doc.run_frame();
+        doc.check_rows(0, 5);
+
+        // Growing the list again reuses the released rows.
+        doc.context.open();
+        doc.list->set_item_count(1000);
+        doc.context.close();
+        doc.run_frame();
+        doc.check_rows(0, 10 + overscan);
+        TEST_CHECK(doc.rows_created == 10 + overscan);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    test::HeadlessRml rml{ "virtual_list_tests" };
+    rml_context = rml.context;
+    std::string_view filter = argc > 1 ? argv[1] : "";
+
+    return test::run_tests({
+        { "rows_cover_viewport", test_rows_cover_viewport },
+        { "scroll_updates_rows_immediately", test_scroll_updates_rows_immediately },
+        { "rows_recycled_while_scrolling", test_rows_recycled_while_scrolling },
+        { "item_count_change_releases_rows", test_item_count_change_releases_rows },
+    }, filter);
+}